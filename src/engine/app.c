@@ -9,6 +9,8 @@
 #include "controls.h"
 #include "graphics.h"
 #include "assets.h"
+#include "transition.h"
+#include "trig.h"
 
 #include "stdlib.h"
 #include "math.h"
@@ -25,6 +27,8 @@ static SDL_Window* window;
 static SDL_Renderer* rend;
 /// Canvas
 static FRAME* canvas;
+/// Render context of the main thread
+static RENDER_CTX canvasCtx;
 
 /// (Timer) old ticks
 static int oldTicks;
@@ -32,11 +36,19 @@ static int oldTicks;
 static int newTicks;
 /// (Timer) delta time
 static int deltaTime;
+/// (Timer) time not yet simulated in fixed step mode, 1/60000 s units
+static int stepTime;
+/// Maximum amount of steps per frame
+#define MAX_STEPS 5
 
 /// Canvas pos
 static SDL_Point canvasPos;
 /// Canvas size
 static SDL_Point canvasSize;
+/// Canvas scale (window surface only)
+static int canvasScale;
+/// Window surface
+static SDL_Surface* winSurf;
 
 /// Current scene
 static SCENE currentScene;
@@ -119,6 +131,49 @@ static void app_calc_canvas_prop(int winWidth, int winHeight)
         canvasPos.y = winHeight/2 - canvasSize.y/2;
         canvasPos.x = 0;
     }
+
+    // When drawing to the window surface, use the
+    // largest integer scale that fits
+    if(config.windowSurface)
+    {
+        canvasScale = winWidth / config.canvasWidth;
+        if(winHeight / config.canvasHeight < canvasScale)
+            canvasScale = winHeight / config.canvasHeight;
+        if(canvasScale < 1) canvasScale = 1;
+
+        canvasSize.x = config.canvasWidth * canvasScale;
+        canvasSize.y = config.canvasHeight * canvasScale;
+        canvasPos.x = winWidth/2 - canvasSize.x/2;
+        canvasPos.y = winHeight/2 - canvasSize.y/2;
+    }
+}
+
+/// Clear the window surface area outside the canvas
+/// < surf Window surface
+static void app_clear_borders(SDL_Surface* surf)
+{
+    Uint32 black = SDL_MapRGB(surf->format,0,0,0);
+    SDL_Rect r;
+
+    // Top & bottom
+    if(canvasPos.y > 0)
+    {
+        r = (SDL_Rect){0,0,surf->w,canvasPos.y};
+        SDL_FillRect(surf,&r,black);
+
+        r = (SDL_Rect){0,canvasPos.y+canvasSize.y,surf->w,surf->h - (canvasPos.y+canvasSize.y)};
+        SDL_FillRect(surf,&r,black);
+    }
+
+    // Left & right
+    if(canvasPos.x > 0)
+    {
+        r = (SDL_Rect){0,canvasPos.y,canvasPos.x,canvasSize.y};
+        SDL_FillRect(surf,&r,black);
+
+        r = (SDL_Rect){canvasPos.x+canvasSize.x,canvasPos.y,surf->w - (canvasPos.x+canvasSize.x),canvasSize.y};
+        SDL_FillRect(surf,&r,black);
+    }
 }
 
 /// Initialize SDL
@@ -150,6 +205,14 @@ static int app_init_SDL()
     isFullscreen = config.fullscreen == 1;
     // app_toggle_fullscreen();
 
+    // No renderer needed when drawing to the window surface
+    if(config.windowSurface)
+    {
+        rend = NULL;
+        SDL_ShowCursor(0);
+        return 0;
+    }
+
     // Create renderer
     rend = SDL_CreateRenderer(window,-1,SDL_RENDERER_SOFTWARE);
     if(rend == NULL)
@@ -181,18 +244,35 @@ static int app_init(SCENE* arrScenes, int count, const char* assPath)
         return 1;
     }
 
-    // Load assets
+    set_lazy_assets(config.lazyAssets == 1, config.assetBudget * 1024);
+    set_asset_atlas(config.atlas == 1);
+
+    // Load assets, use the prebaked pack if there is one.
+    // The list then adds what is not in the pack
+    if(config.packPath[0] != '\0')
+    {
+        load_asset_pack(config.packPath);
+    }
     if(load_assets(config.assPath) != 0)
     {
         return 1;
     }
 
+    // Watch asset files for changes
+    if(config.hotReload == 1 && watch_assets() != 0)
+    {
+        printf("Hot reloading is not available!\n");
+    }
+
     // Set global renderer & init graphics
     init_graphics();
+    init_transitions();
+    init_trig();
     set_global_renderer(rend);
 
     // Gen palette
     fr_gen_palette();
+    fr_set_depth(config.texDepth);
 
     // Create frame
     canvas = frame_create(config.canvasWidth,config.canvasHeight);
@@ -200,7 +280,8 @@ static int app_init(SCENE* arrScenes, int count, const char* assPath)
     {
         return 1;
     }
-    bind_frame(canvas);
+    init_render_ctx(&canvasCtx,canvas);
+    bind_render_ctx(&canvasCtx);
 
     // Calculate canvas pos & size
     int w,h;
@@ -280,14 +361,10 @@ static void app_events()
 
 }   
 
-/// Update application
-/// < delta Delta time in milliseconds
-static void app_update(Uint32 delta)
+/// Update application by one step
+/// < tm Time multiplier
+static void app_step(float tm)
 {
-    float tm = (float)((float)delta/1000.0f) / (1.0f/60.0f);
-    /// Limit tm (in other words, limit minimum fps)
-    if(tm > 5.0) tm = 5.0;
-
     // Quit
     if(get_key_state(SDL_SCANCODE_LCTRL) == DOWN &&
        get_key_state(SDL_SCANCODE_Q) == PRESSED)
@@ -323,6 +400,35 @@ static void app_update(Uint32 delta)
 
 }
 
+/// Update application
+/// < delta Delta time in milliseconds
+static void app_update(Uint32 delta)
+{
+    // In fixed step mode every step is exactly 1/60 s, so
+    // the simulation does not depend on the frame rate
+    if(config.fixedStep)
+    {
+        stepTime += delta * 60;
+
+        int steps = 0;
+        for(; stepTime >= 1000 && steps < MAX_STEPS; steps++)
+        {
+            app_step(1.0f);
+            stepTime -= 1000;
+        }
+        if(steps == MAX_STEPS)
+            stepTime = 0;
+
+        return;
+    }
+
+    float tm = (float)((float)delta/1000.0f) / (1.0f/60.0f);
+    /// Limit tm (in other words, limit minimum fps)
+    if(tm > 5.0) tm = 5.0;
+
+    app_step(tm);
+}
+
 /// Draw application
 static void app_draw()
 {
@@ -339,6 +445,20 @@ static void app_draw()
         globalScene.on_draw();
     }
 
+    // Draw the frame straight to the window surface
+    if(config.windowSurface)
+    {
+        // Fetched every frame, since resizing invalidates it
+        winSurf = SDL_GetWindowSurface(window);
+        if(winSurf == NULL) return;
+
+        app_clear_borders(winSurf);
+        frame_draw_to_surface(canvas,winSurf,canvasPos.x,canvasPos.y,canvasScale);
+
+        SDL_UpdateWindowSurface(window);
+        return;
+    }
+
     // Update frame texture
     frame_update_tex(canvas);
 
@@ -352,7 +472,11 @@ static void app_draw()
 /// Destroy application
 static void app_destroy()
 {
-    SDL_DestroyRenderer(rend);
+    frame_destroy(canvas);
+    frame_pool_clear();
+
+    if(rend != NULL)
+        SDL_DestroyRenderer(rend);
     SDL_DestroyWindow(window);
 
     SDL_JoystickClose(joy);
@@ -399,6 +523,7 @@ int app_run(SCENE* arrScenes, int count, CONFIG c)
         app_events();
         app_update(deltaTime);
         app_draw();
+        update_assets();
         newTicks = SDL_GetTicks();
 
         // Wait
@@ -4,40 +4,587 @@
 #include "assets.h"
 
 #include "SDL2/SDL.h"
+#include "SDL2/SDL_image.h"
 
 #include "stdio.h"
 #include "stdlib.h"
 #include "stdbool.h"
 
 #include "list.h"
+#include "pack.h"
+#include "watch.h"
+#include "tilemap.h"
+#include "mask.h"
 
 /// Asset type enum
 enum
 {
     T_BITMAP = 0,
+    T_TILEMAP = 1,
 };
 
 /// Asset type
 typedef struct
 {
     void* data; /// Asset data
-    char name[64]; /// Asset name
+    char* name; /// Asset name
     int type; /// Asset type
+    bool packed; /// Is the data stored in the asset pack
+    char* path; /// File path (lazily loaded assets only)
+    bool pinned; /// Never evicted
+    int lastUse; /// Frame of the last use
+    int prev; /// Previous in the LRU list (more recently used)
+    int next; /// Next in the LRU list (less recently used)
+    int reloadSerial; /// Serial of the latest reload request
+    bool atlased; /// Is the data a region of an atlas
+    MASK* mask; /// Collision mask of a bitmap, NULL if not loaded yet
+    bool failed; /// Did the lazy load fail, not retried until reloaded
+    int version; /// Changed whenever the data is replaced
 }
 ASSET;
 
+/// Bitmap reload job
+typedef struct RELOAD_JOB
+{
+    int index; /// Asset index
+    int serial; /// Reload serial
+    char path[256]; /// File path
+    BITMAP* bmp; /// Result, NULL on error
+    struct RELOAD_JOB* next; /// Next finished job
+}
+RELOAD_JOB;
+
+/// Asset loading job
+typedef struct
+{
+    char name[256]; /// Asset name
+    char path[256]; /// File path
+    int type; /// Asset type
+    void* data; /// Result, NULL on error
+    char err[128]; /// Error message
+}
+LOAD_JOB;
+
+/// Initial asset array capacity
+#define ASSET_MIN_CAPACITY 32
+/// Atlas width
+#define ATLAS_WIDTH 256
+/// Maximum atlas height
+#define ATLAS_HEIGHT 256
+/// Maximum bitmap width or height to put to an atlas
+#define ATLAS_MAX_ITEM 128
+/// Maximum amount of loader threads
+#define MAX_LOAD_THREADS 16
+
 /// Word parse count index
 static unsigned int wordIndex;
-/// Path
-static char* path;
-/// Name
-static char* name;
 /// Asset type
 static int assType;
 /// Assets array
-static ASSET assets[1024];
+static ASSET* assets;
 /// Asset count
 static unsigned int assCount;
+/// Asset array capacity
+static unsigned int assCapacity;
+/// Name hash table, holds asset indices (-1 if empty)
+static int* table;
+/// Hash table size (power of two)
+static unsigned int tableSize;
+/// Bitmaps pointing to the asset pack
+static BITMAP* packBitmaps;
+/// Loading jobs
+static LOAD_JOB* jobs;
+/// Loading job count
+static int jobCount;
+/// Next job to take
+static SDL_atomic_t nextJob;
+
+/// Is lazy loading enabled
+static bool lazy;
+/// Are loaded bitmaps put to atlases
+static bool useAtlas;
+/// Atlas pixel data
+static Uint8** atlases;
+/// Atlas count
+static int atlasCount;
+/// Memory budget for lazily loaded bitmaps in bytes
+static unsigned int budget;
+/// Resident bytes of lazily loaded bitmaps
+static unsigned int resident;
+/// Current frame, for LRU
+static int useFrame;
+/// Is hot reloading enabled
+static bool watching;
+/// Finished reload jobs
+static RELOAD_JOB* reloaded;
+/// Reload list lock
+static SDL_mutex* reloadLock;
+/// Reload jobs in progress
+static SDL_atomic_t reloadsRunning;
+
+/// Most recently used resident asset
+static int lruHead = -1;
+/// Least recently used resident asset
+static int lruTail = -1;
+/// Is the image loader initialized
+static bool imageReady = false;
+
+/// Hash a name (FNV-1a)
+/// < str Name
+/// > Hash value
+static Uint32 hash_name(const char* str)
+{
+    Uint32 h = 2166136261u;
+    for(; *str != '\0'; str++)
+    {
+        h ^= (Uint8)*str;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/// Find the hash table slot of a name
+/// < str Name
+/// > Slot index, either empty or holding the name
+static unsigned int find_slot(const char* str)
+{
+    unsigned int mask = tableSize-1;
+    unsigned int i = hash_name(str) & mask;
+    while(table[i] != -1 && strcmp(assets[table[i]].name,str) != 0)
+    {
+        i = (i+1) & mask;
+    }
+    return i;
+}
+
+/// Resize the hash table and insert all the assets again
+/// < size New size (power of two)
+/// > 0 on success, 1 on error
+static int resize_table(unsigned int size)
+{
+    int* t = (int*)malloc(sizeof(int) * size);
+    if(t == NULL)
+    {
+        return 1;
+    }
+    free(table);
+    table = t;
+    tableSize = size;
+
+    memset(table,0xFF,sizeof(int) * size);
+    unsigned int i = 0;
+    unsigned int slot;
+    for(; i < assCount; i++)
+    {
+        slot = find_slot(assets[i].name);
+        // The first asset with the same name wins
+        if(table[slot] == -1)
+            table[slot] = i;
+    }
+
+    return 0;
+}
+
+/// Create the collision mask of a bitmap again
+/// < a Asset
+static void update_mask(ASSET* a)
+{
+    BITMAP* b = (BITMAP*)a->data;
+
+    destroy_mask(a->mask);
+    a->mask = b->data != NULL ? create_mask(b) : NULL;
+}
+
+/// Add an asset to the registry
+/// < n Name
+/// < p File path, NULL if none
+/// < data Asset data
+/// < type Asset type
+/// < packed Is the data stored in the asset pack
+/// > 0 on success, 1 on error
+static int add_asset(const char* n, const char* p, void* data, int type, bool packed)
+{
+    // Grow the asset array
+    if(assCount >= assCapacity)
+    {
+        unsigned int cap = assCapacity == 0 ? ASSET_MIN_CAPACITY : assCapacity*2;
+        ASSET* a = (ASSET*)realloc(assets,sizeof(ASSET) * cap);
+        if(a == NULL)
+        {
+            return 1;
+        }
+        assets = a;
+        assCapacity = cap;
+    }
+
+    // Keep the table at most half full
+    if((assCount+1)*2 > tableSize && resize_table(tableSize == 0 ? ASSET_MIN_CAPACITY*2 : tableSize*2) != 0)
+    {
+        return 1;
+    }
+
+    ASSET* a = &assets[assCount];
+    a->name = (char*)malloc(strlen(n)+1);
+    if(a->name == NULL)
+    {
+        return 1;
+    }
+    strcpy(a->name,n);
+    a->path = NULL;
+    if(p != NULL)
+    {
+        a->path = (char*)malloc(strlen(p)+1);
+        if(a->path == NULL)
+        {
+            free(a->name);
+            return 1;
+        }
+        strcpy(a->path,p);
+    }
+    a->data = data;
+    a->type = type;
+    a->packed = packed;
+    a->reloadSerial = 0;
+    a->atlased = false;
+    a->mask = NULL;
+    a->failed = false;
+    a->version = 0;
+    a->pinned = !lazy || packed;
+    a->lastUse = 0;
+    a->prev = -1;
+    a->next = -1;
+
+    // Collision masks are made when the pixels are loaded
+    if(type == T_BITMAP)
+        update_mask(a);
+
+    unsigned int slot = find_slot(n);
+    if(table[slot] == -1)
+        table[slot] = assCount;
+
+    assCount ++;
+
+    return 0;
+}
+
+/// Remove an asset from the LRU list
+/// < i Asset index
+static void lru_unlink(int i)
+{
+    ASSET* a = &assets[i];
+    if(a->prev != -1) assets[a->prev].next = a->next;
+    else lruHead = a->next;
+    if(a->next != -1) assets[a->next].prev = a->prev;
+    else lruTail = a->prev;
+
+    a->prev = -1;
+    a->next = -1;
+}
+
+/// Put an asset to the front of the LRU list
+/// < i Asset index
+static void lru_push(int i)
+{
+    ASSET* a = &assets[i];
+    a->prev = -1;
+    a->next = lruHead;
+    if(lruHead != -1) assets[lruHead].prev = i;
+    lruHead = i;
+    if(lruTail == -1) lruTail = i;
+}
+
+/// Add a lazily loaded bitmap, data is loaded on first use
+/// < n Name
+/// < p File path
+/// > 0 on success, 1 on error
+static int add_lazy_bitmap(const char* n, const char* p)
+{
+    BITMAP* b = (BITMAP*)malloc(sizeof(BITMAP));
+    if(b == NULL)
+    {
+        return 1;
+    }
+    b->w = 0;
+    b->h = 0;
+    b->data = NULL;
+    b->pitch = 0;
+
+    if(add_asset(n,p,(void*)b,T_BITMAP,false) != 0)
+    {
+        free(b);
+        return 1;
+    }
+
+    return 0;
+}
+
+/// Make sure a lazily loaded bitmap is resident
+/// and mark it used
+/// < i Asset index
+/// > True if the data is available
+static bool use_lazy_bitmap(int i)
+{
+    ASSET* a = &assets[i];
+    BITMAP* b = (BITMAP*)a->data;
+
+    if(b->data == NULL)
+    {
+        // Do not go to the disk on every draw call for a broken file
+        if(a->failed) return false;
+
+        // The bitmap struct stays, only the pixels come and go
+        char err[128];
+        BITMAP* tmp = decode_bitmap(a->path,err,128);
+        if(tmp == NULL)
+        {
+            printf("%s\n",err);
+            a->failed = true;
+            return false;
+        }
+        *b = *tmp;
+        free(tmp);
+
+        // The file may have changed while the pixels were evicted
+        a->version ++;
+
+        // The mask is kept when the pixels are evicted
+        if(a->mask == NULL)
+            update_mask(a);
+
+        resident += b->w * b->h;
+        if(!a->pinned)
+            lru_push(i);
+    }
+    else if(!a->pinned && lruHead != i)
+    {
+        lru_unlink(i);
+        lru_push(i);
+    }
+
+    a->lastUse = useFrame;
+    return true;
+}
+
+/// Initialize the image loader. SDL_image does not initialize
+/// itself thread-safely, so this must run on the main thread
+/// before any decoding worker is started
+/// > 0 on success, 1 on error
+static int init_image_loader()
+{
+    if(imageReady) return 0;
+
+    if((IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) == 0)
+    {
+        printf("Failed to initialize SDL_image: %s\n",IMG_GetError());
+        return 1;
+    }
+    imageReady = true;
+
+    return 0;
+}
+
+/// Destroy the result of a loading job
+/// < j Loading job
+static void destroy_job_data(LOAD_JOB* j)
+{
+    if(j->type == T_TILEMAP)
+        destroy_tilemap((TILEMAP*)j->data);
+    else
+        destroy_bitmap((BITMAP*)j->data);
+}
+
+/// Decode jobs until there are none left
+/// < param Unused
+/// > 0
+static int load_worker(void* param)
+{
+    int i;
+    LOAD_JOB* j;
+    while( (i = SDL_AtomicAdd(&nextJob,1)) < jobCount)
+    {
+        j = &jobs[i];
+        if(j->type == T_TILEMAP)
+            j->data = (void*)decode_tilemap(j->path,j->err,128);
+        else
+            j->data = (void*)decode_bitmap(j->path,j->err,128);
+    }
+    return 0;
+}
+
+/// Decode the collected assets in parallel
+/// > 0 on success, 1 on error
+static int run_jobs()
+{
+    SDL_Thread* threads[MAX_LOAD_THREADS];
+    int threadCount = SDL_GetCPUCount() - 1;
+    if(threadCount > MAX_LOAD_THREADS) threadCount = MAX_LOAD_THREADS;
+    if(threadCount > jobCount-1) threadCount = jobCount-1;
+
+    SDL_AtomicSet(&nextJob,0);
+
+    // Start workers, the main thread works, too
+    int i = 0;
+    int started = 0;
+    for(; i < threadCount; i++)
+    {
+        threads[started] = SDL_CreateThread(load_worker,"load_worker",NULL);
+        if(threads[started] != NULL)
+            started ++;
+    }
+    load_worker(NULL);
+    for(i=0; i < started; i++)
+    {
+        SDL_WaitThread(threads[i],NULL);
+    }
+
+    // Register in list order, report the first error
+    int ret = 0;
+    for(i=0; i < jobCount; i++)
+    {
+        if(ret == 0 && jobs[i].data == NULL)
+        {
+            SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!",jobs[i].err,NULL);
+            ret = 1;
+        }
+        else if(ret == 0 && add_asset(jobs[i].name,jobs[i].path,jobs[i].data,jobs[i].type,false) != 0)
+        {
+            destroy_job_data(&jobs[i]);
+            ret = 1;
+        }
+        else if(ret != 0 && jobs[i].data != NULL)
+        {
+            destroy_job_data(&jobs[i]);
+        }
+    }
+
+    return ret;
+}
+
+/// Compare atlas candidates, taller first
+/// < a Asset index 1
+/// < b Asset index 2
+/// > Comparison result
+static int cmp_height(const void* a, const void* b)
+{
+    int ia = *(const int*)a;
+    int ib = *(const int*)b;
+    int d = ((BITMAP*)assets[ib].data)->h - ((BITMAP*)assets[ia].data)->h;
+    return d != 0 ? d : ia - ib;
+}
+
+/// Put small loaded bitmaps to atlases. Each bitmap
+/// then becomes a region in an atlas
+/// > 0 on success, 1 on error
+static int build_atlases()
+{
+    int* items = (int*)malloc(sizeof(int) * (assCount+1));
+    int* pos = (int*)malloc(sizeof(int) * (assCount+1) * 3);
+    if(items == NULL || pos == NULL)
+    {
+        free(items);
+        free(pos);
+        return 1;
+    }
+
+    // Find candidates
+    int count = 0;
+    int i = 0;
+    BITMAP* b;
+    for(; i < assCount; i++)
+    {
+        b = (BITMAP*)assets[i].data;
+        if(assets[i].type == T_BITMAP && !assets[i].packed && !assets[i].atlased
+           && b->data != NULL && b->w <= ATLAS_MAX_ITEM && b->h <= ATLAS_MAX_ITEM)
+        {
+            items[count ++] = i;
+        }
+    }
+    qsort(items,count,sizeof(int),cmp_height);
+
+    // Shelf packing: place bitmaps from left to right, and
+    // start a new shelf (or atlas) when a row is full
+    int first = atlasCount;
+    int at = first;
+    int x = 0, y = 0, shelfH = 0;
+    int heights[64];
+    heights[0] = 0;
+    for(i=0; i < count; i++)
+    {
+        b = (BITMAP*)assets[items[i]].data;
+        if(x + b->w > ATLAS_WIDTH)
+        {
+            x = 0;
+            y += shelfH;
+            shelfH = 0;
+        }
+        if(y + b->h > ATLAS_HEIGHT)
+        {
+            if(at-first+1 >= 64) break;
+            at ++;
+            x = 0;
+            y = 0;
+            shelfH = 0;
+            heights[at-first] = 0;
+        }
+
+        pos[i*3] = at;
+        pos[i*3 +1] = x;
+        pos[i*3 +2] = y;
+
+        x += b->w;
+        if(b->h > shelfH) shelfH = b->h;
+        if(y + shelfH > heights[at-first]) heights[at-first] = y + shelfH;
+    }
+    count = i;
+    int newCount = count > 0 ? at-first+1 : 0;
+
+    // Allocate atlases
+    Uint8** arr = (Uint8**)realloc(atlases,sizeof(Uint8*) * (atlasCount + newCount + 1));
+    if(arr == NULL)
+    {
+        free(items);
+        free(pos);
+        return 1;
+    }
+    atlases = arr;
+    for(i=0; i < newCount; i++)
+    {
+        atlases[first+i] = (Uint8*)malloc(ATLAS_WIDTH * heights[i]);
+        if(atlases[first+i] == NULL)
+        {
+            for(--i; i >= 0; i--)
+                free(atlases[first+i]);
+            free(items);
+            free(pos);
+            return 1;
+        }
+        memset(atlases[first+i],255,ATLAS_WIDTH * heights[i]);
+    }
+    atlasCount += newCount;
+
+    // Copy pixels and turn bitmaps into views
+    Uint8* dst;
+    int row;
+    for(i=0; i < count; i++)
+    {
+        b = (BITMAP*)assets[items[i]].data;
+        dst = atlases[pos[i*3]] + pos[i*3 +2]*ATLAS_WIDTH + pos[i*3 +1];
+        for(row=0; row < b->h; row++)
+        {
+            memcpy(dst + row*ATLAS_WIDTH, b->data + row*b->pitch, b->w);
+        }
+
+        free(b->data);
+        b->data = dst;
+        b->pitch = ATLAS_WIDTH;
+        assets[items[i]].atlased = true;
+    }
+
+    free(items);
+    free(pos);
+
+    return 0;
+}
 
 /// Load assets from list
 /// > 0 on success, 1 on error
@@ -46,8 +593,16 @@ static int load_from_list()
     int i = 0;
 
     wordIndex = 0;
-    assCount = 0;
     unsigned int wordCount = get_list_word_count();
+
+    // Every entry takes three words
+    jobs = (LOAD_JOB*)malloc(sizeof(LOAD_JOB) * (wordCount/3 +1));
+    if(jobs == NULL)
+    {
+        return 1;
+    }
+    jobCount = 0;
+
     for(i=0; i <= wordCount; i++)
     {
         if(wordIndex == 0)
@@ -57,60 +612,89 @@ static int load_from_list()
                 assType = T_BITMAP;
                 wordIndex = 2;
             }
-            
+            else if(strcmp(get_list_word(i).data,"tilemap") == 0)
+            {
+                assType = T_TILEMAP;
+                wordIndex = 2;
+            }
+
         }
         else
         {
             if(wordIndex == 2)
             {
-                name = get_list_word(i).data;
+                snprintf(jobs[jobCount].name,256,"%s",get_list_word(i).data);
             }
             else if(wordIndex == 1)
             {
-                path = get_list_word(i).data;
-                
-                bool success = false;
-
-                void* p = NULL;
-
-                // Load file
+                // Queue file
                 switch(assType)
                 {
                     case T_BITMAP:
+                    case T_TILEMAP:
                     {
-                        p = (void*)load_bitmap(path);
-                        if(p == NULL)
-                        {
-                            return 1;
-                        }
-                        success = true;
+                        // Bitmaps already loaded from the pack are skipped
+                        if(assType == T_BITMAP && get_asset_handle(jobs[jobCount].name) != -1)
+                            break;
+
+                        snprintf(jobs[jobCount].path,256,"%s",get_list_word(i).data);
+                        jobs[jobCount].type = assType;
+                        jobs[jobCount].data = NULL;
+                        jobCount ++;
                         break;
                     }
 
                     default:
                         break;
                 }
-                if(success)
-                {
-                    assets[assCount].data = p;
-                    assets[assCount].type = assType;
-                    strcpy(assets[assCount].name,name);
-                }
-
-                assCount ++;
             }
 
             wordIndex --;
         }
     }
 
-    return 0;
+    int ret = 0;
+    if(lazy)
+    {
+        // Only register bitmaps, pixels are loaded when used.
+        // Other assets are still loaded now
+        int left = 0;
+        for(i=0; i < jobCount && ret == 0; i++)
+        {
+            if(jobs[i].type == T_BITMAP)
+                ret = add_lazy_bitmap(jobs[i].name,jobs[i].path);
+            else
+                jobs[left ++] = jobs[i];
+        }
+        jobCount = left;
+        if(ret == 0 && jobCount > 0)
+            ret = run_jobs();
+    }
+    else if(jobCount > 0)
+    {
+        ret = run_jobs();
+
+        // Atlases are built only from bitmaps that stay resident
+        if(ret == 0 && useAtlas)
+            ret = build_atlases();
+    }
+
+    free(jobs);
+    jobs = NULL;
+    jobCount = 0;
+
+    return ret;
 }
 
 /// Load assets
 int load_assets(const char* path)
 {
 
+    if(init_image_loader() != 0)
+    {
+        return 1;
+    }
+
     // Parse file
     if(load_list(path) != 0 || load_from_list() != 0)
     {
@@ -120,33 +704,366 @@ int load_assets(const char* path)
     return 0;
 }
 
-/// Get bitmap by name
-BITMAP* get_bitmap(const char* name)
+/// Load assets from a prebaked pack
+int load_asset_pack(const char* path)
+{
+    if(pack_open(path) != 0)
+    {
+        return 1;
+    }
+
+    unsigned int count = pack_get_count();
+    packBitmaps = (BITMAP*)malloc(sizeof(BITMAP) * count);
+    if(packBitmaps == NULL)
+    {
+        pack_close();
+        return 1;
+    }
+
+    // Bitmap data points straight to the pack
+    int i = 0;
+    for(; i < count; i++)
+    {
+        packBitmaps[i] = pack_get_bitmap(i);
+
+        if(add_asset(pack_get_name(i),NULL,(void*)&packBitmaps[i],T_BITMAP,true) != 0)
+        {
+            destroy_assets();
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/// Decode a changed bitmap
+/// < param Reload job
+/// > 0
+static int reload_worker(void* param)
+{
+    RELOAD_JOB* j = (RELOAD_JOB*)param;
+
+    char err[128];
+    j->bmp = decode_bitmap(j->path,err,128);
+    if(j->bmp == NULL)
+    {
+        printf("%s\n",err);
+    }
+
+    // Hand the result to the main thread
+    SDL_LockMutex(reloadLock);
+    j->next = reloaded;
+    reloaded = j;
+    SDL_UnlockMutex(reloadLock);
+
+    SDL_AtomicAdd(&reloadsRunning,-1);
+
+    return 0;
+}
+
+/// Start reloading the assets using a changed file
+/// < path File path
+static void on_file_changed(const char* path)
 {
     int i = 0;
     for(; i < assCount; i++)
     {
-        if(assets[i].type == T_BITMAP && strcmp(assets[i].name,name) == 0)
+        if(assets[i].type != T_BITMAP || assets[i].path == NULL
+            || strcmp(assets[i].path,path) != 0)
+            continue;
+
+        // A lazily loaded bitmap that is not resident
+        // will be loaded from the new file anyway
+        if(lazy && ((BITMAP*)assets[i].data)->data == NULL)
+            continue;
+
+        RELOAD_JOB* j = (RELOAD_JOB*)malloc(sizeof(RELOAD_JOB));
+        if(j == NULL) continue;
+
+        j->index = i;
+        j->serial = ++ assets[i].reloadSerial;
+        snprintf(j->path,256,"%s",path);
+        j->bmp = NULL;
+        j->next = NULL;
+
+        SDL_AtomicAdd(&reloadsRunning,1);
+        SDL_Thread* t = SDL_CreateThread(reload_worker,"reload_worker",(void*)j);
+        if(t == NULL)
+        {
+            SDL_AtomicAdd(&reloadsRunning,-1);
+            free(j);
+            continue;
+        }
+        SDL_DetachThread(t);
+    }
+}
+
+/// Swap finished reloads into the registry
+static void swap_reloaded()
+{
+    SDL_LockMutex(reloadLock);
+    RELOAD_JOB* j = reloaded;
+    reloaded = NULL;
+    SDL_UnlockMutex(reloadLock);
+
+    RELOAD_JOB* next;
+    ASSET* a;
+    BITMAP* b;
+    for(; j != NULL; j = next)
+    {
+        next = j->next;
+        a = &assets[j->index];
+        b = (BITMAP*)a->data;
+
+        // A new version is worth another lazy load
+        if(j->bmp != NULL && j->serial == a->reloadSerial)
+            a->failed = false;
+
+        // Only the latest request of an asset counts
+        if(j->bmp != NULL && j->serial == a->reloadSerial
+           && !(lazy && b->data == NULL))
+        {
+            if(lazy) resident = resident - b->w * b->h + j->bmp->w * j->bmp->h;
+
+            // The bitmap struct stays, pointers to it remain valid
+            if(!a->atlased)
+                free(b->data);
+            a->atlased = false;
+            *b = *j->bmp;
+            free(j->bmp);
+            update_mask(a);
+            a->version ++;
+        }
+        else
+        {
+            destroy_bitmap(j->bmp);
+        }
+        free(j);
+    }
+}
+
+/// Wait for reloads in progress and drop their results
+static void stop_reloads()
+{
+    while(SDL_AtomicGet(&reloadsRunning) > 0)
+    {
+        SDL_Delay(1);
+    }
+    SDL_LockMutex(reloadLock);
+    RELOAD_JOB* j = reloaded;
+    reloaded = NULL;
+    SDL_UnlockMutex(reloadLock);
+
+    RELOAD_JOB* next;
+    for(; j != NULL; j = next)
+    {
+        next = j->next;
+        destroy_bitmap(j->bmp);
+        free(j);
+    }
+}
+
+/// Watch asset files for changes
+int watch_assets()
+{
+    // Reloads are decoded in worker threads
+    if(init_image_loader() != 0 || watch_init() != 0)
+    {
+        return 1;
+    }
+
+    if(reloadLock == NULL)
+    {
+        reloadLock = SDL_CreateMutex();
+        if(reloadLock == NULL)
         {
-            return (BITMAP*)assets[i].data;
+            watch_close();
+            return 1;
         }
     }
 
-    return NULL;
+    int i = 0;
+    for(; i < assCount; i++)
+    {
+        if(assets[i].path != NULL)
+            watch_file(assets[i].path);
+    }
+    watching = true;
+
+    return 0;
+}
+
+/// Get asset handle by name
+int get_asset_handle(const char* name)
+{
+    if(tableSize == 0) return -1;
+
+    return table[find_slot(name)];
+}
+
+/// Get bitmap by handle
+BITMAP* get_bitmap_handle(int handle)
+{
+    if(handle < 0 || handle >= assCount || assets[handle].type != T_BITMAP)
+        return NULL;
+
+    if(lazy && !assets[handle].packed && !use_lazy_bitmap(handle))
+        return NULL;
+
+    return (BITMAP*)assets[handle].data;
+}
+
+/// Get the data version of an asset
+int get_asset_version(int handle)
+{
+    if(handle < 0 || handle >= assCount)
+        return -1;
+
+    return assets[handle].version;
+}
+
+/// Get collision mask by handle
+MASK* get_mask_handle(int handle)
+{
+    if(handle < 0 || handle >= assCount || assets[handle].type != T_BITMAP)
+        return NULL;
+
+    // Lazily loaded bitmaps get their mask on first use
+    if(assets[handle].mask == NULL && lazy && !assets[handle].packed)
+        use_lazy_bitmap(handle);
+
+    return assets[handle].mask;
+}
+
+/// Get bitmap by name
+BITMAP* get_bitmap(const char* name)
+{
+    int handle = get_asset_handle(name);
+
+    // The pointer may be kept around, so it must stay valid
+    if(handle >= 0 && !assets[handle].pinned)
+    {
+        if(assets[handle].data != NULL && ((BITMAP*)assets[handle].data)->data != NULL)
+            lru_unlink(handle);
+        assets[handle].pinned = true;
+    }
+
+    return get_bitmap_handle(handle);
+}
+
+/// Get tilemap by name
+TILEMAP* get_tilemap(const char* name)
+{
+    int handle = get_asset_handle(name);
+    if(handle < 0 || assets[handle].type != T_TILEMAP)
+        return NULL;
+
+    return (TILEMAP*)assets[handle].data;
+}
+
+/// Enable lazy loading
+void set_lazy_assets(bool enable, unsigned int bytes)
+{
+    lazy = enable;
+    budget = bytes;
+}
+
+/// Enable atlases
+void set_asset_atlas(bool enable)
+{
+    useAtlas = enable;
+}
+
+/// Update assets
+void update_assets()
+{
+    // Swap reloaded bitmaps between frames
+    if(watching)
+    {
+        watch_poll(on_file_changed);
+        swap_reloaded();
+    }
+
+    if(!lazy) return;
+
+    // Evict least recently used bitmaps, but not
+    // the ones used during this frame
+    BITMAP* b;
+    while(resident > budget && lruTail != -1 && assets[lruTail].lastUse < useFrame)
+    {
+        int i = lruTail;
+        lru_unlink(i);
+
+        b = (BITMAP*)assets[i].data;
+        resident -= b->w * b->h;
+        free(b->data);
+        b->data = NULL;
+    }
+
+    useFrame ++;
 }
 
 
 /// Destroy loaded asset files
 void destroy_assets()
 {
+    if(watching)
+    {
+        watch_close();
+        stop_reloads();
+        watching = false;
+    }
+
     int i = 0;
     for(; i < assCount; i++)
     {
         int t = assets[i].type;
-        if(t == T_BITMAP)
+        if(t == T_BITMAP && assets[i].atlased)
+        {
+            free(assets[i].data);
+        }
+        else if(t == T_BITMAP && !assets[i].packed)
         {
             BITMAP* b = (BITMAP*)assets[i].data;
             destroy_bitmap(b);
         }
+        else if(t == T_TILEMAP)
+        {
+            destroy_tilemap((TILEMAP*)assets[i].data);
+        }
+        free(assets[i].name);
+        free(assets[i].path);
+        destroy_mask(assets[i].mask);
+    }
+
+    free(assets);
+    assets = NULL;
+    assCount = 0;
+    assCapacity = 0;
+
+    free(table);
+    table = NULL;
+    tableSize = 0;
+
+    for(i=0; i < atlasCount; i++)
+    {
+        free(atlases[i]);
     }
-}
\ No newline at end of file
+    free(atlases);
+    atlases = NULL;
+    atlasCount = 0;
+
+    resident = 0;
+    lruHead = -1;
+    lruTail = -1;
+
+    free(packBitmaps);
+    packBitmaps = NULL;
+    pack_close();
+
+    if(imageReady)
+    {
+        IMG_Quit();
+        imageReady = false;
+    }
+}
@@ -5,17 +5,83 @@
 #define __ASSETS__
 
 #include "bitmap.h"
+#include "tilemap.h"
+#include "mask.h"
 
-/// Load assets from an asset list file
+#include "stdbool.h"
+
+/// Load assets from an asset list file. Bitmaps already
+/// loaded from a pack are skipped
 /// < path List path
 /// > 0 on success, 1 on error
 int load_assets(const char* path);
 
-/// Get bitmap by name
+/// Load assets from a prebaked asset pack
+/// < path Pack path
+/// > 0 on success, 1 on error
+int load_asset_pack(const char* path);
+
+/// Get bitmap by name. The bitmap is pinned in memory,
+/// so the pointer can be kept
 /// < name Bitmap name
 /// > A bitmap, NULL if not exist
 BITMAP* get_bitmap(const char* name);
 
+/// Get asset handle by name. Resolve the handle once
+/// and use it for later lookups
+/// < name Asset name
+/// > Asset handle, -1 if not exist
+int get_asset_handle(const char* name);
+
+/// Get bitmap by handle. With lazy loading the data is loaded
+/// here on first use, and the pointer is only valid until
+/// the next call to update_assets
+/// < handle Asset handle
+/// > A bitmap, NULL if not exist or if a lazy load failed.
+///   A failed load is not retried until the file is reloaded.
+///   The drawing functions skip NULL bitmaps
+BITMAP* get_bitmap_handle(int handle);
+
+/// Get the data version of an asset. It changes whenever the
+/// data is replaced, for example by a hot reload, so caches
+/// built from the data can tell when to rebuild
+/// < handle Asset handle
+/// > Version, -1 if not exist
+int get_asset_version(int handle);
+
+/// Get the collision mask of a bitmap by handle. Masks are
+/// made from the color key when the bitmap is loaded
+/// < handle Asset handle
+/// > A mask, NULL if not exist
+MASK* get_mask_handle(int handle);
+
+/// Get tilemap by name
+/// < name Tilemap name
+/// > A tilemap, NULL if not exist
+TILEMAP* get_tilemap(const char* name);
+
+/// Enable lazy loading, must be called before loading assets.
+/// Listed bitmaps are then loaded on first use, and the least
+/// recently used ones are evicted when over the budget
+/// < enable Enable lazy loading
+/// < bytes Memory budget in bytes
+void set_lazy_assets(bool enable, unsigned int bytes);
+
+/// Enable atlases, must be called before loading assets.
+/// Small bitmaps loaded from a list are then packed to
+/// shared atlases, and their data points to a region
+/// < enable Enable atlases
+void set_asset_atlas(bool enable);
+
+/// Watch the files of loaded assets and reload
+/// them when changed (Linux only)
+/// > 0 on success, 1 on error
+int watch_assets();
+
+/// Update assets, swaps reloaded bitmaps in and
+/// evicts bitmaps over the budget. Call once per frame
+void update_assets();
+
 /// Destroy loaded asset files
 void destroy_assets();
 
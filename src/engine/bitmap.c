@@ -9,76 +9,158 @@
 #include "math.h"
 #include "stdio.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/// Quantisation tables (v/85, shifted to the channel position)
+#define Q(v) ((v)/85)
+#define Q4(v) Q(v), Q(v+1), Q(v+2), Q(v+3)
+#define Q16(v) Q4(v), Q4(v+4), Q4(v+8), Q4(v+12)
+#define Q64(v) Q16(v), Q16(v+16), Q16(v+32), Q16(v+48)
+static const Uint8 quantR[256] = { Q64(0), Q64(64), Q64(128), Q64(192) };
+#undef Q
+#define Q(v) (((v)/85) << 2)
+static const Uint8 quantG[256] = { Q64(0), Q64(64), Q64(128), Q64(192) };
+#undef Q
+#define Q(v) (((v)/85) << 4)
+static const Uint8 quantB[256] = { Q64(0), Q64(64), Q64(128), Q64(192) };
+#undef Q
+#undef Q4
+#undef Q16
+#undef Q64
+
+
+/// Quantise a row of BGRA pixels to color indices
+/// < src Source pixels, bytes in B,G,R,A order
+/// < dst Destination indices
+/// < w Pixel count
+static void quantise_row(const Uint8* src, Uint8* dst, int w)
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    // Sixteen pixels at a time. v/85 equals (v*772) >> 16
+    // for every byte value
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mul = _mm_set1_epi16(772);
+    const __m128i amask = _mm_set1_epi32(0xFF000000);
+    const __m128i rmask = _mm_set1_epi32(0x03);
+    const __m128i gmask = _mm_set1_epi32(0x0C);
+    const __m128i bmask = _mm_set1_epi32(0x30);
+    const __m128i transp = _mm_set1_epi32(255);
+
+    __m128i v, q, idx, opaque;
+    __m128i out[4];
+    int i;
+    for(; x+16 <= w; x += 16)
+    {
+        for(i=0; i < 4; i++)
+        {
+            v = _mm_loadu_si128((const __m128i*)(src + (x+i*4)*4));
 
-/// Load bitmap
-BITMAP* load_bitmap(const char* path)
+            q = _mm_packus_epi16(
+                _mm_mulhi_epu16(_mm_unpacklo_epi8(v,zero),mul),
+                _mm_mulhi_epu16(_mm_unpackhi_epi8(v,zero),mul));
+
+            // index = r | g << 2 | b << 4
+            idx = _mm_and_si128(_mm_srli_epi32(q,16),rmask);
+            idx = _mm_or_si128(idx,_mm_and_si128(_mm_srli_epi32(q,6),gmask));
+            idx = _mm_or_si128(idx,_mm_and_si128(_mm_slli_epi32(q,4),bmask));
+
+            // Anything not fully opaque is transparent
+            opaque = _mm_cmpeq_epi32(_mm_and_si128(v,amask),amask);
+            out[i] = _mm_or_si128(_mm_and_si128(opaque,idx),_mm_andnot_si128(opaque,transp));
+        }
+
+        _mm_storeu_si128((__m128i*)(dst + x),
+            _mm_packus_epi16(_mm_packs_epi32(out[0],out[1]),_mm_packs_epi32(out[2],out[3])));
+    }
+#endif
+
+    const Uint8* p;
+    for(; x < w; x++)
+    {
+        p = src + x*4;
+        if(p[3] != 255)
+        {
+            dst[x] = 255;
+            continue;
+        }
+        dst[x] = quantR[p[2]] | quantG[p[1]] | quantB[p[0]];
+    }
+}
+
+/// Decode bitmap without reporting errors
+BITMAP* decode_bitmap(const char* path, char* err, int errLen)
 {
     // Allocate memory
     BITMAP* bmp = (BITMAP*)malloc(sizeof(BITMAP));
     if(bmp == NULL)
     {
-        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Failed to allocate memory for a bitmap!\n",NULL);
+        snprintf(err,errLen,"Failed to allocate memory for a bitmap!\n");
         return NULL;
     }
 
     // Load surface
-    SDL_Surface* surf = IMG_Load(path);
-    if(surf == NULL)
+    SDL_Surface* loaded = IMG_Load(path);
+    if(loaded == NULL)
     {
-        char err[128];
-        snprintf(err,128,"Failed to load a bitmap in %s!",path);
-
-        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!",err,NULL);
+        snprintf(err,errLen,"Failed to load a bitmap in %s!",path);
+        free(bmp);
         return NULL;
     }
 
-    unsigned int pixelCount = surf->w * surf->h;
+    // Whatever the file had (paletted, 24-bit...),
+    // make it 32-bit B,G,R,A in memory
+    SDL_Surface* surf = SDL_ConvertSurfaceFormat(loaded,SDL_PIXELFORMAT_BGRA32,0);
+    SDL_FreeSurface(loaded);
+    if(surf == NULL)
+    {
+        snprintf(err,errLen,"Failed to convert a bitmap in %s!",path);
+        free(bmp);
+        return NULL;
+    }
 
     bmp->w = surf->w;
     bmp->h = surf->h;
+    bmp->pitch = surf->w;
 
-    // Allocate image and temp buffer data
-    bmp->data = (Uint8*)malloc(sizeof(Uint8) * pixelCount);
+    // Allocate image data
+    bmp->data = (Uint8*)malloc(sizeof(Uint8) * surf->w * surf->h);
     if(bmp->data == NULL) 
     {
-        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Failed to allocate memory for a bitmap!\n",NULL);
+        snprintf(err,errLen,"Failed to allocate memory for a bitmap!\n");
+        free(bmp);
+        SDL_FreeSurface(surf);
         return NULL;
     }
 
     // Go through the data
-    int i = 0;
-    Uint8 pixel;
-    Uint8 r,g,b,a;
-    Uint8 er,eg,eb;
-    Uint8* pdata = (Uint8*)surf->pixels;
-    for(; i < pixelCount; i++)
+    if(SDL_MUSTLOCK(surf)) SDL_LockSurface(surf);
+    int y = 0;
+    for(; y < surf->h; y++)
     {
-        a = pdata[i*4 +3];
-        if(a != 255)
-        {
-            bmp->data[i] = 255;
-            continue;
-        }
-
-        r = pdata[i*4 +2];
-        g = pdata[i*4 +1];
-        b = pdata[i*4 ];
+        quantise_row((Uint8*)surf->pixels + y*surf->pitch, bmp->data + y*surf->w, surf->w);
+    }
+    if(SDL_MUSTLOCK(surf)) SDL_UnlockSurface(surf);
 
-        er = (r / 85);
-        eg = (g / 85);
-        eg = eg << 2;
-        eb = (b / 85);
-        eb = eb << 4;
+    // Free surface
+    SDL_FreeSurface(surf);
 
-        pixel = 0;
-        pixel = er | eg | eb;
+    return bmp;
+}
 
-        bmp->data[i] = pixel;
+/// Load bitmap
+BITMAP* load_bitmap(const char* path)
+{
+    char err[128];
+    BITMAP* bmp = decode_bitmap(path,err,128);
+    if(bmp == NULL)
+    {
+        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!",err,NULL);
     }
 
-    // Free surface
-    free(surf);
-
     return bmp;
 }
 
@@ -96,5 +178,5 @@ Uint8 bmp_get_pixel(BITMAP* b, int x, int y)
 {
     if(x < 0 || y < 0 || x >= b->w || y >= b->h) return 0;
 
-    return b->data[y * b->w + x];
+    return b->data[y * b->pitch + x];
 }
\ No newline at end of file
@@ -12,6 +12,7 @@ typedef struct
     int w; /// Bitmap width
     int h; /// Bitmap height
     Uint8* data; /// Pixel data
+    int pitch; /// Row length in pixels (may be larger than w)
 }
 BITMAP;
 
@@ -20,6 +21,14 @@ BITMAP;
 /// > Returns a new bitmap (pointer)
 BITMAP* load_bitmap(const char* path);
 
+/// Decode bitmap without reporting errors, safe
+/// to call from worker threads
+/// < path Bitmap path
+/// < err Error message buffer
+/// < errLen Error message buffer size
+/// > Returns a new bitmap (pointer), NULL on error
+BITMAP* decode_bitmap(const char* path, char* err, int errLen);
+
 /// Destroy bitmap
 void destroy_bitmap(BITMAP* bmp);
 
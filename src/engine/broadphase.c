@@ -0,0 +1,349 @@
+/// Broad-phase collision (source)
+/// (c) 2017 Jani Nykänen
+
+#include "broadphase.h"
+#include "state.h"
+
+#include "stdlib.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/// Narrow-phase batch size, a multiple of four
+#define BATCH_SIZE 64
+
+/// Candidate pairs waiting for the narrow-phase
+typedef struct
+{
+    float ax0[BATCH_SIZE], ay0[BATCH_SIZE], ax1[BATCH_SIZE], ay1[BATCH_SIZE];
+    float bx0[BATCH_SIZE], by0[BATCH_SIZE], bx1[BATCH_SIZE], by1[BATCH_SIZE];
+    int ida[BATCH_SIZE]; /// Ids in set 1, -1 for a query box
+    int idb[BATCH_SIZE]; /// Ids in set 2
+    int count; /// Candidate count
+}
+BATCH;
+
+/// Test the candidates and write the overlapping ones
+/// < bt Batch
+/// < out Output
+/// < written Amount already written
+/// < max Maximum amount
+/// < pairs Write pairs instead of single ids
+/// > Amount written after the batch
+static int flush_batch(BATCH* bt, int* out, int written, int max, bool pairs)
+{
+    int i = 0;
+    int n = bt->count;
+    int bits;
+    int k;
+
+    // Pad the last group with boxes that never overlap
+    for(; n % 4 != 0; n++)
+    {
+        bt->ax0[n] = 1.0f; bt->ax1[n] = 0.0f;
+        bt->bx0[n] = 1.0f; bt->bx1[n] = 0.0f;
+        bt->ay0[n] = bt->ay1[n] = bt->by0[n] = bt->by1[n] = 0.0f;
+    }
+
+    for(i=0; i < n && written < max; i += 4)
+    {
+#ifdef __SSE2__
+        __m128 m = _mm_and_ps(
+            _mm_cmplt_ps(_mm_loadu_ps(bt->ax0+i),_mm_loadu_ps(bt->bx1+i)),
+            _mm_cmpgt_ps(_mm_loadu_ps(bt->ax1+i),_mm_loadu_ps(bt->bx0+i)));
+        m = _mm_and_ps(m,_mm_and_ps(
+            _mm_cmplt_ps(_mm_loadu_ps(bt->ay0+i),_mm_loadu_ps(bt->by1+i)),
+            _mm_cmpgt_ps(_mm_loadu_ps(bt->ay1+i),_mm_loadu_ps(bt->by0+i))));
+        bits = _mm_movemask_ps(m);
+#else
+        bits = 0;
+        for(k=0; k < 4; k++)
+        {
+            if(bt->ax0[i+k] < bt->bx1[i+k] && bt->ax1[i+k] > bt->bx0[i+k]
+                && bt->ay0[i+k] < bt->by1[i+k] && bt->ay1[i+k] > bt->by0[i+k])
+                bits |= 1 << k;
+        }
+#endif
+
+        for(k=0; k < 4 && written < max; k++)
+        {
+            if(!(bits & (1 << k))) continue;
+
+            if(pairs)
+            {
+                out[written*2] = bt->ida[i+k];
+                out[written*2 +1] = bt->idb[i+k];
+            }
+            else
+            {
+                out[written] = bt->idb[i+k];
+            }
+            written ++;
+        }
+    }
+
+    bt->count = 0;
+    return written;
+}
+
+/// Add a candidate pair
+/// < bt Batch
+/// < a Set 1, NULL for a query box
+/// < ia Id in set 1
+/// < q Query box, if no set 1
+/// < b Set 2
+/// < ib Id in set 2
+static void add_candidate(BATCH* bt, BROADPHASE* a, int ia, const float* q, BROADPHASE* b, int ib)
+{
+    int n = bt->count ++;
+    if(a != NULL)
+    {
+        bt->ax0[n] = a->minX[ia]; bt->ay0[n] = a->minY[ia];
+        bt->ax1[n] = a->maxX[ia]; bt->ay1[n] = a->maxY[ia];
+    }
+    else
+    {
+        bt->ax0[n] = q[0]; bt->ay0[n] = q[1];
+        bt->ax1[n] = q[2]; bt->ay1[n] = q[3];
+    }
+    bt->bx0[n] = b->minX[ib]; bt->by0[n] = b->minY[ib];
+    bt->bx1[n] = b->maxX[ib]; bt->by1[n] = b->maxY[ib];
+    bt->ida[n] = ia;
+    bt->idb[n] = ib;
+}
+
+/// Find the first sorted index with a left edge not below a value
+/// < bp Box set
+/// < x Value
+/// > Index
+static int lower_bound(BROADPHASE* bp, float x)
+{
+    int lo = 0;
+    int hi = bp->count;
+    int mid;
+    while(lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        if(bp->minX[bp->order[mid]] < x)
+            lo = mid +1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/// Create a broad-phase box set
+BROADPHASE* create_broadphase(int capacity)
+{
+    if(capacity <= 0)
+    {
+        return NULL;
+    }
+
+    BROADPHASE* bp = (BROADPHASE*)calloc(1,sizeof(BROADPHASE));
+    if(bp == NULL)
+    {
+        return NULL;
+    }
+
+    bp->capacity = capacity;
+    bp->minX = (float*)calloc(capacity,sizeof(float));
+    bp->minY = (float*)calloc(capacity,sizeof(float));
+    bp->maxX = (float*)calloc(capacity,sizeof(float));
+    bp->maxY = (float*)calloc(capacity,sizeof(float));
+    bp->active = (bool*)calloc(capacity,sizeof(bool));
+    bp->listed = (bool*)calloc(capacity,sizeof(bool));
+    bp->order = (int*)calloc(capacity,sizeof(int));
+
+    if(bp->minX == NULL || bp->minY == NULL || bp->maxX == NULL || bp->maxY == NULL
+        || bp->active == NULL || bp->listed == NULL || bp->order == NULL)
+    {
+        destroy_broadphase(bp);
+        return NULL;
+    }
+
+    return bp;
+}
+
+/// Begin a tick
+void bp_begin(BROADPHASE* bp)
+{
+    int i = 0;
+    for(; i < bp->count; i++)
+    {
+        bp->active[bp->order[i]] = false;
+    }
+}
+
+/// Set a box
+void bp_set(BROADPHASE* bp, int id, float x, float y, float w, float h)
+{
+    if(id < 0 || id >= bp->capacity) return;
+
+    bp->minX[id] = x;
+    bp->minY[id] = y;
+    bp->maxX[id] = x + w;
+    bp->maxY[id] = y + h;
+    bp->active[id] = true;
+
+    // New ids go to the end and are sorted in bp_end
+    if(!bp->listed[id])
+    {
+        bp->listed[id] = true;
+        bp->order[bp->count ++] = id;
+    }
+}
+
+/// End a tick
+void bp_end(BROADPHASE* bp)
+{
+    int i = 0;
+    int n = 0;
+    int id;
+    int j;
+    float x;
+
+    bp->maxW = 0.0f;
+    for(; i < bp->count; i++)
+    {
+        id = bp->order[i];
+        if(!bp->active[id])
+        {
+            bp->listed[id] = false;
+            continue;
+        }
+
+        if(bp->maxX[id] - bp->minX[id] > bp->maxW)
+            bp->maxW = bp->maxX[id] - bp->minX[id];
+
+        // Insertion sort, almost sorted already
+        x = bp->minX[id];
+        for(j = n; j > 0 && bp->minX[bp->order[j-1]] > x; j--)
+        {
+            bp->order[j] = bp->order[j-1];
+        }
+        bp->order[j] = id;
+        n ++;
+    }
+    bp->count = n;
+}
+
+/// Find boxes overlapping a box
+int bp_query_box(BROADPHASE* bp, float x, float y, float w, float h, int* out, int max)
+{
+    BATCH bt;
+    bt.count = 0;
+
+    const float q[4] = {x, y, x+w, y+h};
+    int written = 0;
+    int i = lower_bound(bp,x - bp->maxW);
+    int id;
+    for(; i < bp->count && written < max; i++)
+    {
+        id = bp->order[i];
+        if(bp->minX[id] >= q[2]) break;
+
+        add_candidate(&bt,NULL,-1,q,bp,id);
+        if(bt.count == BATCH_SIZE)
+            written = flush_batch(&bt,out,written,max,false);
+    }
+
+    return flush_batch(&bt,out,written,max,false);
+}
+
+/// Find overlapping boxes between two sets
+int bp_query_pairs(BROADPHASE* a, BROADPHASE* b, int* out, int max)
+{
+    BATCH bt;
+    bt.count = 0;
+
+    int written = 0;
+    int i = 0;
+    int j;
+    int start = 0;
+    int ia, ib;
+    for(; i < a->count && written < max; i++)
+    {
+        ia = a->order[i];
+
+        if(a == b)
+        {
+            // Later boxes in the same set
+            start = i+1;
+        }
+        else
+        {
+            // Boxes far on the left cannot touch this
+            // or any later box
+            while(start < b->count && b->minX[b->order[start]] + b->maxW <= a->minX[ia])
+                start ++;
+        }
+
+        for(j = start; j < b->count; j++)
+        {
+            ib = b->order[j];
+            if(b->minX[ib] >= a->maxX[ia]) break;
+
+            add_candidate(&bt,a,ia,NULL,b,ib);
+            if(bt.count == BATCH_SIZE)
+                written = flush_batch(&bt,out,written,max,true);
+        }
+    }
+
+    return flush_batch(&bt,out,written,max,true);
+}
+
+/// Get the size of the box set state
+int bp_state_size(BROADPHASE* bp)
+{
+    int n = bp->capacity;
+    return (int)(sizeof(float)*4*n + sizeof(bool)*2*n + sizeof(int)*(n+1) + sizeof(float));
+}
+
+/// Save the box set state
+Uint8* bp_save(BROADPHASE* bp, Uint8* out)
+{
+    int n = bp->capacity;
+
+    out = save_bytes(out,bp->minX,sizeof(float)*n);
+    out = save_bytes(out,bp->minY,sizeof(float)*n);
+    out = save_bytes(out,bp->maxX,sizeof(float)*n);
+    out = save_bytes(out,bp->maxY,sizeof(float)*n);
+    out = save_bytes(out,bp->active,sizeof(bool)*n);
+    out = save_bytes(out,bp->listed,sizeof(bool)*n);
+    out = save_bytes(out,bp->order,sizeof(int)*n);
+    out = save_bytes(out,&bp->count,sizeof(int));
+    return save_bytes(out,&bp->maxW,sizeof(float));
+}
+
+/// Load the box set state
+const Uint8* bp_load(BROADPHASE* bp, const Uint8* in)
+{
+    int n = bp->capacity;
+
+    in = load_bytes(in,bp->minX,sizeof(float)*n);
+    in = load_bytes(in,bp->minY,sizeof(float)*n);
+    in = load_bytes(in,bp->maxX,sizeof(float)*n);
+    in = load_bytes(in,bp->maxY,sizeof(float)*n);
+    in = load_bytes(in,bp->active,sizeof(bool)*n);
+    in = load_bytes(in,bp->listed,sizeof(bool)*n);
+    in = load_bytes(in,bp->order,sizeof(int)*n);
+    in = load_bytes(in,&bp->count,sizeof(int));
+    return load_bytes(in,&bp->maxW,sizeof(float));
+}
+
+/// Destroy a box set
+void destroy_broadphase(BROADPHASE* bp)
+{
+    if(bp == NULL) return;
+
+    free(bp->minX);
+    free(bp->minY);
+    free(bp->maxX);
+    free(bp->maxY);
+    free(bp->active);
+    free(bp->listed);
+    free(bp->order);
+    free(bp);
+}
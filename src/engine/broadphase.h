@@ -0,0 +1,94 @@
+/// Broad-phase collision (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __BROADPHASE__
+#define __BROADPHASE__
+
+#include "SDL2/SDL.h"
+
+#include "stdbool.h"
+
+/// Box set sorted on the x axis. Boxes are identified by
+/// an id below the capacity, usually an entity pool slot
+typedef struct
+{
+    int capacity; /// Maximum id + 1
+    float* minX; /// Left edges
+    float* minY; /// Top edges
+    float* maxX; /// Right edges
+    float* maxY; /// Bottom edges
+    bool* active; /// Is the box set during this tick
+    bool* listed; /// Is the id in the sorted list
+    int* order; /// Ids sorted by the left edge
+    int count; /// Listed id count
+    float maxW; /// Widest box
+}
+BROADPHASE;
+
+/// Create a broad-phase box set
+/// < capacity Maximum id + 1
+/// > A new box set, NULL on error
+BROADPHASE* create_broadphase(int capacity);
+
+/// Begin a tick. Boxes that are not set again before
+/// bp_end are removed
+/// < bp Box set
+void bp_begin(BROADPHASE* bp);
+
+/// Set a box
+/// < bp Box set
+/// < id Box id
+/// < x Left edge
+/// < y Top edge
+/// < w Width
+/// < h Height
+void bp_set(BROADPHASE* bp, int id, float x, float y, float w, float h);
+
+/// End a tick. Removed boxes are dropped and the order from
+/// the previous tick is sorted again, which is nearly linear
+/// as the boxes move little between ticks
+/// < bp Box set
+void bp_end(BROADPHASE* bp);
+
+/// Find boxes overlapping a box
+/// < bp Box set
+/// < x Left edge
+/// < y Top edge
+/// < w Width
+/// < h Height
+/// < out Overlapping ids
+/// < max Maximum amount of ids
+/// > Amount of ids written
+int bp_query_box(BROADPHASE* bp, float x, float y, float w, float h, int* out, int max);
+
+/// Find overlapping boxes between two sets. If both sets are
+/// the same, each overlapping pair is reported once
+/// < a Box set 1
+/// < b Box set 2
+/// < out Id pairs, id from set 1 followed by id from set 2
+/// < max Maximum amount of pairs
+/// > Amount of pairs written
+int bp_query_pairs(BROADPHASE* a, BROADPHASE* b, int* out, int max);
+
+/// Get the size of the box set state
+/// < bp Box set
+/// > Size in bytes
+int bp_state_size(BROADPHASE* bp);
+
+/// Save the box set state
+/// < bp Box set
+/// < out Output, at least bp_state_size bytes
+/// > End of the written state
+Uint8* bp_save(BROADPHASE* bp, Uint8* out);
+
+/// Load a state saved from a box set of the same capacity
+/// < bp Box set
+/// < in Input
+/// > End of the read state
+const Uint8* bp_load(BROADPHASE* bp, const Uint8* in);
+
+/// Destroy a box set
+/// < bp Box set to destroy
+void destroy_broadphase(BROADPHASE* bp);
+
+#endif // __BROADPHASE__
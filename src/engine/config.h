@@ -13,7 +13,18 @@ typedef struct
     int canvasHeight; /// Canvas height
     int fps; /// Maximum fps
     int fullscreen; /// Fullscreen enabled
+    int windowSurface; /// Draw directly to the window surface
+    int texDepth; /// Canvas texture color depth (16 or 32)
     char assPath[256]; /// Asset path
+    char packPath[256]; /// Prebaked asset pack path
+    int lazyAssets; /// Load bitmaps on first use
+    int assetBudget; /// Memory budget of lazily loaded bitmaps in kilobytes
+    int hotReload; /// Reload changed asset files
+    int atlas; /// Pack small bitmaps to atlases
+    int maxObstacles; /// Obstacle capacity
+    int maxCoins; /// Coin capacity
+    int fixedStep; /// Simulate in fixed 1/60 s steps
+    int seed; /// Random seed, 0 for a time-based seed
 }
 CONFIG;
 
@@ -0,0 +1,30 @@
+/// Fixed-point math (source)
+/// (c) 2017 Jani Nykänen
+
+#include "fixed.h"
+
+#include "trig.h"
+
+/// Convert a float to a fixed-point number
+FIXED fx_from_float(float f)
+{
+    return (FIXED)(f * (float)FIXED_ONE);
+}
+
+/// Convert a fixed-point number to a float
+float fx_to_float(FIXED a)
+{
+    return (float)a / (float)FIXED_ONE;
+}
+
+/// Fixed-point sine
+FIXED fx_sin(FIXED rad)
+{
+    return fx_sin_angle(fx_to_angle(rad));
+}
+
+/// Fixed-point cosine
+FIXED fx_cos(FIXED rad)
+{
+    return fx_sin_angle((ANGLE)(fx_to_angle(rad) + ANGLE_TURN/4));
+}
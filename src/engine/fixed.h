@@ -0,0 +1,77 @@
+/// Fixed-point math (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __FIXED__
+#define __FIXED__
+
+#include "SDL2/SDL.h"
+
+/// 16.16 fixed-point number. Only integer operations are used,
+/// so results are the same on every compiler and machine
+typedef Sint32 FIXED;
+
+/// Fixed-point vector 2
+typedef struct
+{
+    FIXED x,y;
+}
+FXVEC2;
+
+/// Fractional bits
+#define FIXED_SHIFT 16
+/// One
+#define FIXED_ONE (1 << FIXED_SHIFT)
+
+/// Fixed-point constant. Use with constant expressions only,
+/// the conversion is then done by the compiler
+/// < v Value
+#define fx(v) ((FIXED)((v) * 65536.0 + ((v) < 0 ? -0.5 : 0.5)))
+
+/// Fixed-point number from an integer
+/// < i Integer
+#define fx_int(i) ((FIXED)((i) * FIXED_ONE))
+
+/// Multiply two fixed-point numbers
+/// < a Number a
+/// < b Number b
+#define fx_mul(a,b) ((FIXED)(((Sint64)(a) * (Sint64)(b)) >> FIXED_SHIFT))
+
+/// Divide two fixed-point numbers
+/// < a Number a
+/// < b Number b
+#define fx_div(a,b) ((FIXED)(((Sint64)(a) * FIXED_ONE) / (b)))
+
+/// Floor to an integer
+/// < a Number
+#define fx_floor(a) ((int)((a) >> FIXED_SHIFT))
+
+/// Round to an integer
+/// < a Number
+#define fx_round(a) ((int)(((a) + FIXED_ONE/2) >> FIXED_SHIFT))
+
+/// Fixed-point vector 2
+/// < x X component
+/// < y Y component
+#define fxvec2(x,y) (FXVEC2){x,y}
+
+/// Convert a float to a fixed-point number
+/// < f Float
+/// > Fixed-point number
+FIXED fx_from_float(float f);
+
+/// Convert a fixed-point number to a float
+/// < a Fixed-point number
+/// > Float
+float fx_to_float(FIXED a);
+
+/// Fixed-point sine
+/// < rad Angle in radians
+/// > Sine
+FIXED fx_sin(FIXED rad);
+
+/// Fixed-point cosine
+/// < rad Angle in radians
+/// > Cosine
+FIXED fx_cos(FIXED rad);
+
+#endif // __FIXED__
@@ -3,6 +3,7 @@
 
 #include "graphics.h"
 #include "frame.h"
+#include "mathext.h"
 #include "stdio.h"
 #include "malloc.h"
 
@@ -10,9 +11,31 @@
 #include "math.h"
 #include "stdio.h"
 
+/// Frame buffer alignment
+#define FRAME_ALIGN 64
+/// Maximum amount of pooled frames
+#define FRAME_POOL_SIZE 8
+
 /// Global palette
 static Uint8 palette[256];
 
+/// 32-bit texture palette (RGBA8888)
+static Uint32 palette32[256];
+/// 16-bit texture palette (RGB565)
+static Uint16 palette16[256];
+/// Texture color depth
+static int texDepth = 32;
+
+/// Released frames
+static FRAME* pool[FRAME_POOL_SIZE];
+/// Pooled frame count
+static int poolCount;
+
+/// Surface palette lookup table
+static Uint32 surfPalette[256];
+/// Pixel format the surface palette was built for
+static Uint32 surfFormat;
+
 /// Create palette lookup table
 void fr_gen_palette()
 {
@@ -31,93 +54,191 @@ void fr_gen_palette()
         palette[i*3 +1] = g *85;
         palette[i*3 +2] = b *85;
     }
+
+    // Texture pixel lookup tables
+    for(i=0; i < 256; i++)
+    {
+        if(i < 64)
+        {
+            r = palette[i*3];
+            g = palette[i*3 +1];
+            b = palette[i*3 +2];
+        }
+        else
+        {
+            r = g = b = 0;
+        }
+
+        palette32[i] = ((Uint32)r << 24) | ((Uint32)g << 16) | ((Uint32)b << 8) | 0xFF;
+        palette16[i] = (Uint16)( ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3) );
+    }
 }
 
-/// Create frame
-FRAME* frame_create(int w, int h)
+/// Set texture color depth
+void fr_set_depth(int depth)
 {
-    // Allocate memory
-    FRAME* fr = (FRAME*)malloc(sizeof(FRAME));
-    if(fr == NULL)
+    texDepth = depth == 16 ? 16 : 32;
+}
+
+/// Round a size up to frame alignment
+/// < n Size in bytes
+/// > Aligned size
+static size_t fr_align(size_t n)
+{
+    return (n + FRAME_ALIGN-1) & ~(size_t)(FRAME_ALIGN-1);
+}
+
+/// Allocate a frame and its buffers as one aligned block
+/// < w Width
+/// < h Height
+/// < bpp Bytes per pixel in texture data, 0 if no texture data
+/// > A new frame, NULL on error
+static FRAME* fr_alloc(int w, int h, int bpp)
+{
+    size_t headSize = fr_align(sizeof(FRAME));
+    size_t colorSize = fr_align((size_t)w*h);
+    size_t dataSize = fr_align((size_t)w*h*bpp);
+    size_t depthSize = fr_align(sizeof(float) * w);
+
+    Uint8* block = (Uint8*)malloc(headSize + colorSize + dataSize + depthSize + FRAME_ALIGN-1);
+    if(block == NULL)
     {
         printf("Memory allocation error!\n");
         return NULL;
     }
-    fr->data = (Uint8*)malloc(sizeof(Uint8) * w * h *4);
-    if(fr->data == NULL)
+
+    // Align the beginning of the block, every buffer
+    // after the header is then aligned as well
+    Uint8* base = (Uint8*)fr_align((size_t)block);
+
+    FRAME* fr = (FRAME*)base;
+    fr->block = block;
+    fr->colorData = base + headSize;
+    fr->data = bpp > 0 ? fr->colorData + colorSize : NULL;
+    fr->depth = (float*)(fr->colorData + colorSize + dataSize);
+    fr->bpp = bpp;
+    fr->tex = NULL;
+
+    // Store dimensions
+    fr->w = w;
+    fr->h = h;
+    fr->pitch = w;
+
+    // Store size
+    fr->size = w*h;
+
+    // Clear data
+    memset(fr->colorData,0,w*h);
+    if(fr->data != NULL)
+        memset(fr->data,255,w*h*bpp);
+
+    return fr;
+}
+
+/// Create frame
+FRAME* frame_create(int w, int h)
+{
+    FRAME* fr = fr_alloc(w,h,texDepth / 8);
+    if(fr == NULL)
     {
-        free(fr);
-        printf("Memory allocation error!\n");
         return NULL;
     }
-    fr->colorData = (Uint8*)malloc(sizeof(Uint8) * w * h *3);
-    if(fr->data == NULL)
+
+    // Create texture (not needed if there is no renderer,
+    // for example when drawing to the window surface)
+    if(get_global_renderer() == NULL)
     {
-        free(fr);
-        printf("Memory allocation error!\n");
-        return NULL;
+        return fr;
     }
-    fr->depth = (float*)malloc(sizeof(float) * w);
-    if(fr->depth == NULL)
+    Uint32 format = fr->bpp == 2 ? SDL_PIXELFORMAT_RGB565 : SDL_PIXELFORMAT_RGBA8888;
+    fr->tex = SDL_CreateTexture(get_global_renderer(),format,SDL_TEXTUREACCESS_STREAMING ,w,h);
+    if(fr->tex == NULL)
     {
-        free(fr);
-        printf("Memory allocation error!\n");
+        free(fr->block);
+        printf("Failed to create a texture!\n");
         return NULL;
     }
 
-    // Clear data
-    int x = 0;
-    int y = 0;
-    for(; y < h; y++)
-    {
-        for(x=0; x < w; x++)
-        {
-            fr->data[y*w*4 +x*4] = 255;
-            fr->data[y*w*4 +x*4 +1] = 255;
-            fr->data[y*w*4 +x*4 +2] = 255;
-            fr->data[y*w*4 +x*4 +3] = 255;
+    return fr;
+}
 
-            fr->colorData[y*w +x] = 0;
+/// Destroy frame
+void frame_destroy(FRAME* fr)
+{
+    if(fr == NULL) return;
+
+    if(fr->tex != NULL)
+        SDL_DestroyTexture(fr->tex);
+    free(fr->block);
+}
 
+/// Get an offscreen frame from the pool
+FRAME* frame_acquire(int w, int h)
+{
+    // Reuse a released frame of the same size
+    int i = 0;
+    for(; i < poolCount; i++)
+    {
+        if(pool[i]->w == w && pool[i]->h == h)
+        {
+            FRAME* fr = pool[i];
+            pool[i] = pool[--poolCount];
+            return fr;
         }
     }
 
-    // Store dimensions
-    fr->w = w;
-    fr->h = h;
+    // Offscreen frames only need color data
+    return fr_alloc(w,h,0);
+}
 
-    // Store size
-    fr->size = w*h;
+/// Return a frame to the pool
+void frame_release(FRAME* fr)
+{
+    if(fr == NULL) return;
 
-    // Create texture
-    fr->tex = SDL_CreateTexture(get_global_renderer(),SDL_PIXELFORMAT_RGBA8888,SDL_TEXTUREACCESS_STREAMING ,w,h);
-    if(fr->tex == NULL)
+    if(poolCount >= FRAME_POOL_SIZE)
     {
-        free(fr->data);
-        free(fr);
-        printf("Failed to create a texture!\n");
-        return NULL;
+        frame_destroy(fr);
+        return;
     }
+    pool[poolCount ++] = fr;
+}
 
-    return fr;
+/// Destroy pooled frames
+void frame_pool_clear()
+{
+    int i = 0;
+    for(; i < poolCount; i++)
+    {
+        frame_destroy(pool[i]);
+    }
+    poolCount = 0;
 }
 
 /// Update frame texture
 void frame_update_tex(FRAME* fr)
 {
-    if(fr == NULL) return;
+    if(fr == NULL || fr->tex == NULL) return;
 
     int i = 0;
-    int pos = 0;
-    for(; i < (int)fr->size; i++)
+    if(fr->bpp == 2)
     {
-        pos = fr->colorData[i]*3;
-        fr->data[i*4 + 1] = palette[ pos +2 ];
-        fr->data[i*4 + 2] = palette[ pos + 1];
-        fr->data[i*4 + 3] = palette[ pos ];
+        Uint16* d16 = (Uint16*)fr->data;
+        for(; i < (int)fr->size; i++)
+        {
+            d16[i] = palette16[fr->colorData[i]];
+        }
+    }
+    else
+    {
+        Uint32* d32 = (Uint32*)fr->data;
+        for(; i < (int)fr->size; i++)
+        {
+            d32[i] = palette32[fr->colorData[i]];
+        }
     }
 
-    SDL_UpdateTexture(fr->tex,NULL,fr->data,fr->w*4);
+    SDL_UpdateTexture(fr->tex,NULL,fr->data,fr->w*fr->bpp);
 }
 
 /// Copy frame color data
@@ -130,4 +251,129 @@ void copy_frame(FRAME* s, FRAME* d)
     {
         d->colorData[i] = s->colorData[i];
     }
+}
+
+/// Build surface palette for the given pixel format
+/// < fmt Pixel format
+static void fr_gen_surface_palette(const SDL_PixelFormat* fmt)
+{
+    int i = 0;
+    for(; i < 256; i++)
+    {
+        if(i < 64)
+            surfPalette[i] = SDL_MapRGB(fmt,palette[i*3],palette[i*3 +1],palette[i*3 +2]);
+        else
+            surfPalette[i] = SDL_MapRGB(fmt,0,0,0);
+    }
+    surfFormat = fmt->format;
+}
+
+/// Expand a row of color indices to surface pixels
+/// < src Source indices
+/// < w Source width
+/// < out Destination pixels
+/// < bpp Bytes per pixel
+/// < scale Scale factor
+static void fr_expand_row(const Uint8* src, int w, Uint8* out, int bpp, int scale)
+{
+    int x = 0;
+    int i;
+    Uint32 c;
+
+    switch(bpp)
+    {
+    case 4:
+    {
+        Uint32* o = (Uint32*)out;
+        Uint64 cc;
+        for(; x < w; x++)
+        {
+            c = surfPalette[src[x]];
+            cc = (Uint64)c | ((Uint64)c << 32);
+
+            // Two pixels per store, the odd one out last
+            i = 0;
+            for(; i+1 < scale; i += 2)
+            {
+                memcpy(o+i,&cc,sizeof(Uint64));
+            }
+            if(i < scale)
+                o[i] = c;
+
+            o += scale;
+        }
+    }
+    break;
+
+    case 2:
+    {
+        Uint16* o = (Uint16*)out;
+        Uint16 cs;
+        for(; x < w; x++)
+        {
+            cs = (Uint16)surfPalette[src[x]];
+            for(i=0; i < scale; i++)
+                o[i] = cs;
+
+            o += scale;
+        }
+    }
+    break;
+
+    default:
+    {
+        // Generic path, copy bytes of a pixel
+        Uint8* o = out;
+        for(; x < w; x++)
+        {
+            c = surfPalette[src[x]];
+            for(i=0; i < scale; i++)
+            {
+                memcpy(o,&c,bpp);
+                o += bpp;
+            }
+        }
+    }
+    break;
+    }
+}
+
+/// Draw frame to a surface
+void frame_draw_to_surface(FRAME* fr, SDL_Surface* surf, int dx, int dy, int scale)
+{
+    if(fr == NULL || surf == NULL || scale < 1) return;
+
+    int bpp = surf->format->BytesPerPixel;
+    if(surf->format->format != surfFormat)
+    {
+        fr_gen_surface_palette(surf->format);
+    }
+
+    // Visible source area (the canvas may not fit the window)
+    int sx = dx < 0 ? (-dx + scale-1) / scale : 0;
+    int sy = dy < 0 ? (-dy + scale-1) / scale : 0;
+    int ex = min(fr->w, (surf->w - dx) / scale);
+    int ey = min(fr->h, (surf->h - dy) / scale);
+    if(sx >= ex || sy >= ey) return;
+
+    if(SDL_MUSTLOCK(surf) && SDL_LockSurface(surf) != 0) return;
+
+    int rowBytes = (ex-sx) * scale * bpp;
+    Uint8* pixels = (Uint8*)surf->pixels;
+    Uint8* row;
+    int y = sy;
+    int i;
+    for(; y < ey; y++)
+    {
+        // Expand the first line, then copy it to the remaining ones
+        row = pixels + (dy + y*scale) * surf->pitch + (dx + sx*scale) * bpp;
+        fr_expand_row(fr->colorData + y*fr->w + sx, ex-sx, row, bpp, scale);
+
+        for(i=1; i < scale; i++)
+        {
+            memcpy(row + i*surf->pitch, row, rowBytes);
+        }
+    }
+
+    if(SDL_MUSTLOCK(surf)) SDL_UnlockSurface(surf);
 }
\ No newline at end of file
@@ -13,28 +13,61 @@ typedef struct
     int w; /// Width
     int h; /// Height
     Uint8* colorData; /// Color data
+    int pitch; /// Row length in pixels, always w
 
     unsigned int size; /// Actual size in pixels
     float* depth; /// Depth buffer
 
     Uint8* data; /// Frame data
+    int bpp; /// Bytes per pixel in frame data
     SDL_Texture* tex; /// Frame texture   
+    void* block; /// Allocated memory block
 }
 FRAME;
 
 /// Generate global palette
 void fr_gen_palette();
 
+/// Set texture color depth for new frames
+/// < depth Color depth, 16 (RGB565) or 32 (RGBA8888)
+void fr_set_depth(int depth);
+
 /// Creates a new frame
 /// < w Width
 /// < h Height
 /// > A pointer to a new frame
 FRAME* frame_create(int w, int h);
 
+/// Destroy a frame
+/// < fr Frame to destroy
+void frame_destroy(FRAME* fr);
+
+/// Get an offscreen frame (no texture) from the frame pool,
+/// or create a new one if there is none of the same size
+/// < w Width
+/// < h Height
+/// > A frame, NULL on error
+FRAME* frame_acquire(int w, int h);
+
+/// Return an offscreen frame to the frame pool
+/// < fr Frame to release
+void frame_release(FRAME* fr);
+
+/// Destroy all pooled frames
+void frame_pool_clear();
+
 /// Update frame texture
 /// < fr Frame
 void frame_update_tex(FRAME* fr);
 
+/// Draw frame to a surface, scaled by an integer factor
+/// < fr Frame
+/// < surf Target surface
+/// < dx Destination X
+/// < dy Destination Y
+/// < scale Scale factor
+void frame_draw_to_surface(FRAME* fr, SDL_Surface* surf, int dx, int dy, int scale);
+
 /// Copy frame color data
 /// < s Source
 /// < d Destination
@@ -5,6 +5,7 @@
 
 #include "mathext.h"
 #include "transform.h"
+#include "trig.h"
 
 #include "malloc.h"
 #include "stdlib.h"
@@ -30,76 +31,81 @@ static const int MAX_DARKNESS_VALUE = 6;
 
 /// Global renderer
 static SDL_Renderer* grend;
-/// Global frame
-static FRAME* gframe;
 /// Window dim
 static SDL_Point windowDim;
 
-/// Translate x
-static int transX;
-/// Translate y
-static int transY;
-
-/// Global texture used in drawing filled polygons
-static BITMAP* gtex;
-
-/// Is darkness enabled
-static bool darkness;
-/// Darkness value
-static int dvalue;
-/// Darkness begin
-static float darkBegin;
-/// Darkness end
-static float darkEnd;
-/// Darkness step
-static float darkStep;
-
-/// Put pixel function
-static void (*ppfunc) (int,int,Uint8);
-
 /// Put pixel to the screen
+/// < c Render context
 /// < x X coordinate
 /// < y Y coordinate
 /// < index Color index
-static void put_pixel(int x, int y, Uint8 index)
+static void put_pixel(RENDER_CTX* c, int x, int y, Uint8 index)
 {
-    if(index == 255 || x < 0 || y < 0 || x >= gframe->w || y >= gframe->h) return;
-    gframe->colorData[y*gframe->w+x] = index;
+    if(index == 255 || x < 0 || y < 0 || x >= c->frame->w || y >= c->frame->h) return;
+    c->frame->colorData[y*c->frame->w+x] = index;
 }
 
 /// Put pixel to the screen (with darkness enabled)
+/// < c Render context
 /// < x X coordinate
 /// < y Y coordinate
 /// < index Color index
-static void put_pixel_dark(int x, int y, Uint8 index)
+static void put_pixel_dark(RENDER_CTX* c, int x, int y, Uint8 index)
 {
-    if(index == 255 || x < 0 || y < 0 || x >= gframe->w || y >= gframe->h) return;
+    if(index == 255 || x < 0 || y < 0 || x >= c->frame->w || y >= c->frame->h) return;
 
-    if(darkness && dvalue > 0)
+    if(c->darkness && c->dvalue > 0)
     {
         Uint8 col;
-        if(dvalue % 2 == 0)
+        if(c->dvalue % 2 == 0)
         {
-            col = index  + (dvalue+1)/2 *64;
+            col = index  + (c->dvalue+1)/2 *64;
         }
         else
         {
             if( (x % 2 == 0 && y % 2 == 0) || (x % 2 == 1 && y % 2 == 1) )
-                col = index  + (dvalue)/2 *64;
+                col = index  + (c->dvalue)/2 *64;
             else
-                col = index  + (dvalue+2) / 2 *64;
+                col = index  + (c->dvalue+2) / 2 *64;
         }
-        gframe->colorData[y*gframe->w+x] = col;
+        c->frame->colorData[y*c->frame->w+x] = col;
         return;
     }
 
-    gframe->colorData[y*gframe->w+x] = index;
+    c->frame->colorData[y*c->frame->w+x] = index;
 }
 
+/// Render context of threads that have not bound their own
+static RENDER_CTX defaultCtx = {.ppfunc = put_pixel};
+/// Bound render context
+static _Thread_local RENDER_CTX* ctx = &defaultCtx;
+
 /// Initialize graphics
 void init_graphics()
 {
-    ppfunc = put_pixel;
+    defaultCtx.ppfunc = put_pixel;
+}
+
+/// Initialize a render context
+void init_render_ctx(RENDER_CTX* c, FRAME* fr)
+{
+    memset(c,0,sizeof(RENDER_CTX));
+    c->frame = fr;
+    c->ppfunc = put_pixel;
+    tr_init(&c->tr);
+}
+
+/// Bind a render context to the calling thread
+void bind_render_ctx(RENDER_CTX* c)
+{
+    ctx = c != NULL ? c : &defaultCtx;
+    tr_bind(c != NULL ? &c->tr : NULL);
+}
+
+/// Get the bound render context
+RENDER_CTX* get_render_ctx()
+{
+    return ctx;
 }
 
 /// Set global renderer
@@ -117,6 +123,8 @@ SDL_Renderer* get_global_renderer()
 /// Clear screen
 void clear(unsigned char r, unsigned char g, unsigned char b)
 {
+    if(grend == NULL) return;
+
     SDL_SetRenderDrawColor(grend, r,g,b, 255);
     SDL_RenderClear(grend);
 }
@@ -137,24 +145,29 @@ SDL_Point get_dimensions()
 /// Bind frame
 void bind_frame(FRAME* fr)
 {
-    gframe = fr; 
+    ctx->frame = fr; 
 }
 
 /// Return currently used frame
 FRAME* get_current_frame()
 {
-    return gframe;
+    return ctx->frame;
 }
 
 /// Clear frame
 void clear_frame(Uint8 index)
 {
-    memset(gframe->colorData,index,gframe->size);
+    RENDER_CTX* c = ctx;
+    memset(c->frame->colorData,index,c->frame->size);
 }
 
 /// Draw a non-scaled bitmap
 void draw_bitmap(BITMAP* b, int dx, int dy, int flip)
 {
+    // A lazily loaded bitmap may fail to load
+    if(b == NULL) return;
+
+    RENDER_CTX* c = ctx;
     int x; // Screen X
     int y = dy; // Screen Y
     int px = 0; // Pixel X
@@ -165,7 +178,7 @@ void draw_bitmap(BITMAP* b, int dx, int dy, int flip)
     {
         for(x = dx; x < dx+b->w; x++)
         {
-            ppfunc(x,y, b->data[py*b->w +px]);
+            c->ppfunc(c,x,y, b->data[py*b->pitch +px]);
             px ++;
         }
         py ++;
@@ -176,6 +189,9 @@ void draw_bitmap(BITMAP* b, int dx, int dy, int flip)
 /// Draw a non-scaled bitmap with inverted colors
 void draw_inverted_bitmap(BITMAP* b, int dx, int dy, int flip)
 {
+    if(b == NULL) return;
+
+    RENDER_CTX* c = ctx;
     int x; // Screen X
     int y = dy; // Screen Y
     int px = 0; // Pixel X
@@ -188,11 +204,11 @@ void draw_inverted_bitmap(BITMAP* b, int dx, int dy, int flip)
     {
         for(x = dx; x < dx+b->w; x++)
         {
-            index = b->data[py*b->w +px];
+            index = b->data[py*b->pitch +px];
             index = ~index;
             index = index & 0b00111111;
 
-            ppfunc(x,y, index);
+            c->ppfunc(c,x,y, index);
             px ++;
         }
         py ++;
@@ -203,11 +219,14 @@ void draw_inverted_bitmap(BITMAP* b, int dx, int dy, int flip)
 /// Draw a rotated bitmap area
 void draw_rotated_bitmap_area(BITMAP* b,  float trx, float try, int skip, float angle)
 {
+    if(b == NULL) return;
+
+    RENDER_CTX* c = ctx;
     skip ++;
 
     // Rotation matrix B
-    float b11 = cos(angle), b21 = -sin(angle);
-    float b12 = sin(angle), b22 = cos(angle);
+    float b11 = fast_cos(angle), b21 = -fast_sin(angle);
+    float b12 = fast_sin(angle), b22 = fast_cos(angle);
 
     // Inverse of determinant of B
     float detInv = 1.0f / (b11 * b22 - b12 * b21);
@@ -220,11 +239,10 @@ void draw_rotated_bitmap_area(BITMAP* b,  float trx, float try, int skip, float
     int tx = 0;
     int ty = 0;
 
-    // "gframe" stands for "global frame",
-    // so cx and cy point to the center of
+    // cx and cy point to the center of
     // the frame where this thing is drawn to
-    int cx = gframe->w / 2;
-    int cy = gframe->h / 2;
+    int cx = c->frame->w / 2;
+    int cy = c->frame->h / 2;
 
     // Translated coordinates
     int xx, yy;
@@ -236,9 +254,9 @@ void draw_rotated_bitmap_area(BITMAP* b,  float trx, float try, int skip, float
     Uint8 color;
 
     // Draw pixels
-    for(x = 0; x < gframe->w; x++)
+    for(x = 0; x < c->frame->w; x++)
     {
-        for(y = 0; y < gframe->h; y++)
+        for(y = 0; y < c->frame->h; y++)
         {
             if(!(skip == 0 || (x % skip == 0 && y % skip == 0) ) )
                 continue;
@@ -259,8 +277,8 @@ void draw_rotated_bitmap_area(BITMAP* b,  float trx, float try, int skip, float
             while(ty < 0) ty += b->h;
 
             
-            color = b->data[ty*b->w +tx];
-            ppfunc(x,y, color);
+            color = b->data[ty*b->pitch +tx];
+            c->ppfunc(c,x,y, color);
         }
     } 
 }
@@ -268,8 +286,11 @@ void draw_rotated_bitmap_area(BITMAP* b,  float trx, float try, int skip, float
 /// Draw a bitmap region
 void draw_bitmap_region(BITMAP* b, int sx, int sy, int sw, int sh, int dx, int dy, int flip)
 {
-    dx += transX;
-    dy += transY;
+    if(b == NULL) return;
+
+    RENDER_CTX* c = ctx;
+    dx += c->transX;
+    dy += c->transY;
 
     int x; // Screen X
     int y = dy; // Screen Y
@@ -285,7 +306,7 @@ void draw_bitmap_region(BITMAP* b, int sx, int sy, int sw, int sh, int dx, int d
     {
         for(x = beginx; x != endx; x += stepx)
         {
-            ppfunc(x,y, b->data[py*b->w +px]);
+            c->ppfunc(c,x,y, b->data[py*b->pitch +px]);
 
             px ++;
         }
@@ -297,9 +318,12 @@ void draw_bitmap_region(BITMAP* b, int sx, int sy, int sw, int sh, int dx, int d
 /// Draw a skipped bitmap region
 void draw_skipped_bitmap_region(BITMAP* b, int sx, int sy, int sw, int sh, int dx, int dy, int skipx, int skipy, int flip)
 {
+    if(b == NULL) return;
 
-    dx += transX;
-    dy += transY;
+    RENDER_CTX* c = ctx;
+
+    dx += c->transX;
+    dy += c->transY;
 
     int x; // Screen X
     int y = dy; // Screen Y
@@ -322,7 +346,7 @@ void draw_skipped_bitmap_region(BITMAP* b, int sx, int sy, int sw, int sh, int d
             
             if(skipx == 0 || (skipxCount % skipx != 0 && (skipy == 0 || skipyCount % skipy != 0) ))
             {
-                ppfunc(x,y, b->data[py*b->w +px]);
+                c->ppfunc(c,x,y, b->data[py*b->pitch +px]);
             }
 
             px ++;
@@ -337,6 +361,9 @@ void draw_skipped_bitmap_region(BITMAP* b, int sx, int sy, int sw, int sh, int d
 /// Draw a scaled bitmap line
 void draw_scaled_bitmap_region(BITMAP* b, int sx, int sy, int sw, int sh, int dx, int dy, int dw, int dh)
 {
+    if(b == NULL) return;
+
+    RENDER_CTX* c = ctx;
     int x; // Screen X
     int y = dy; // Screen Y
     int px = sx; // Pixel X
@@ -359,13 +386,13 @@ void draw_scaled_bitmap_region(BITMAP* b, int sx, int sy, int sw, int sh, int dx
                 x = -1;
                 continue;
             }
-            else if(x >= gframe->w)
+            else if(x >= c->frame->w)
                 break;
 
             px = (int)(pxf);
             py = (int)(pyf);
 
-            ppfunc(x,y, b->data[py*b->w +px]);
+            c->ppfunc(c,x,y, b->data[py*b->pitch +px]);
             pxf += 1.0f/ssx;
         }
         pyf += 1.0f/ssy;
@@ -376,6 +403,8 @@ void draw_scaled_bitmap_region(BITMAP* b, int sx, int sy, int sw, int sh, int dx
 /// Draw text using a bitmap font
 void draw_text(BITMAP* b, Uint8* text, int len, int dx, int dy, int xoff, int yoff, bool center)
 {
+    if(b == NULL) return;
+
     int x = dx;
     int y = dy;
     int cw = b->w / 16;
@@ -412,8 +441,9 @@ void draw_text(BITMAP* b, Uint8* text, int len, int dx, int dy, int xoff, int yo
 /// Fill rectangle
 void fill_rect(int x, int y, int w, int h, Uint8 index)
 {
-    x += transX;
-    y += transY;
+    RENDER_CTX* c = ctx;
+    x += c->transX;
+    y += c->transY;
 
     int dx = x;
     int dy = y;
@@ -422,7 +452,7 @@ void fill_rect(int x, int y, int w, int h, Uint8 index)
     {
         for(dx = x; dx < x+w; dx++)
         {
-            ppfunc(dx,dy,index);
+            c->ppfunc(c,dx,dy,index);
         }
     }
 }
@@ -430,6 +460,7 @@ void fill_rect(int x, int y, int w, int h, Uint8 index)
 /// Draw a line
 void draw_line(int x1, int y1, int x2, int y2, Uint8 color)
 {
+    RENDER_CTX* c = ctx;
 
     // Bresenham's line algorithm
     int dx = abs(x2-x1), sx = x1<x2 ? 1 : -1;
@@ -438,7 +469,7 @@ void draw_line(int x1, int y1, int x2, int y2, Uint8 color)
      
     for(;;)
     {
-        ppfunc(x1,y1, color);
+        c->ppfunc(c,x1,y1, color);
         
         if (x1==x2 && y1==y2) break;
         e2 = err;
@@ -451,6 +482,7 @@ void draw_line(int x1, int y1, int x2, int y2, Uint8 color)
 /// Draw a textured triangle
 static void _draw_triangle(int x1, int y1, int x2, int y2, int x3, int y3, Uint8 col, int spc)
 {
+    RENDER_CTX* c = ctx;
     // Calculate minimums & maximums
     int maxy = max(y1,max(y2,y3));
     int miny = min(y1,min(y2,y3));
@@ -458,7 +490,7 @@ static void _draw_triangle(int x1, int y1, int x2, int y2, int x3, int y3, Uint8
     int minx = min(x1,min(x2,x3));
 
     // Do not draw if not visible
-    if(maxx < 0 || minx >= gframe->w || maxy < 0 || miny >= gframe->h 
+    if(maxx < 0 || minx >= c->frame->w || maxy < 0 || miny >= c->frame->h 
         || (maxy == miny)) 
         return;
 
@@ -507,13 +539,13 @@ static void _draw_triangle(int x1, int y1, int x2, int y2, int x3, int y3, Uint8
     bool flat = py1 == py2 || py2 == py3 || py1 == py3;
 
     // Draw visible pixels
-    for(y = miny; y <= min(maxy,gframe->h); y++)
+    for(y = miny; y <= min(maxy,c->frame->h); y++)
     {
         if(y >= 0)
         {
-            for(x = max(0,(int)startx); x <= min(gframe->w,(int)endx); x++)
+            for(x = max(0,(int)startx); x <= min(c->frame->w,(int)endx); x++)
             {
-                ppfunc(x,y,col);
+                c->ppfunc(c,x,y,col);
             }
         }
 
@@ -544,8 +576,14 @@ void draw_triangle(int x1, int y1, int x2, int y2, int x3, int y3, Uint8 col)
 /// Set translation
 void set_translation(int x, int y)
 {
-    transX = x;
-    transY = y;
+    ctx->transX = x;
+    ctx->transY = y;
+}
+
+/// Get translation
+SDL_Point get_translation()
+{
+    return (SDL_Point){ctx->transX,ctx->transY};
 }
 
 /// Set darkness
@@ -554,24 +592,25 @@ void set_translation(int x, int y)
 /// < end End depth value
 void set_darkness(bool enable, float start, float end)
 {
-    darkness = enable;
+    RENDER_CTX* c = ctx;
+    c->darkness = enable;
     if(enable)
     {
-        darkBegin = start;
-        darkEnd = end;
-        darkStep = (darkEnd-darkBegin) / 3.0f;
-        ppfunc = put_pixel_dark;
+        c->darkBegin = start;
+        c->darkEnd = end;
+        c->darkStep = (c->darkEnd-c->darkBegin) / 3.0f;
+        c->ppfunc = put_pixel_dark;
     }
     else
     {
-        ppfunc = put_pixel;
+        c->ppfunc = put_pixel;
     }
     
-    dvalue = 0;
+    c->dvalue = 0;
 }
 
 /// Bind a texture
 void bind_texture(BITMAP* tex)
 {
-    gtex = tex;
+    ctx->tex = tex;
 }
\ No newline at end of file
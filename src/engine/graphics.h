@@ -9,6 +9,7 @@
 #include "bitmap.h"
 #include "frame.h"
 #include "vector.h"
+#include "transform.h"
 
 /// Flipping enumerations
 enum
@@ -19,9 +20,42 @@ enum
     FLIP_BOTH = 3,
 };
 
+/// Render context. Each thread draws to the context it has
+/// bound, or to a shared default one
+typedef struct _RENDER_CTX
+{
+    FRAME* frame; /// Target frame
+    int transX; /// Translate x
+    int transY; /// Translate y
+    BITMAP* tex; /// Texture used in drawing filled polygons
+    bool darkness; /// Is darkness enabled
+    int dvalue; /// Darkness value
+    float darkBegin; /// Darkness begin
+    float darkEnd; /// Darkness end
+    float darkStep; /// Darkness step
+    void (*ppfunc) (struct _RENDER_CTX*,int,int,Uint8); /// Put pixel function
+    TRANSFORM tr; /// Transformation
+}
+RENDER_CTX;
+
 /// Initialize graphics
 void init_graphics();
 
+/// Initialize a render context
+/// < c Render context
+/// < fr Target frame
+void init_render_ctx(RENDER_CTX* c, FRAME* fr);
+
+/// Bind a render context, and its transformation, to the
+/// calling thread. The drawing functions below use the bound
+/// context
+/// < c Render context, NULL for the default one
+void bind_render_ctx(RENDER_CTX* c);
+
+/// Get the render context bound to the calling thread
+/// > Render context
+RENDER_CTX* get_render_ctx();
+
 /// Set the global renderer
 /// < rend Renderer
 void set_global_renderer(SDL_Renderer* rend);
@@ -155,6 +189,10 @@ void draw_triangle(int x1, int y1, int x2, int y2, int x3, int y3, Uint8 col);
 /// < y Vertical
 void set_translation(int x, int y);
 
+/// Returns translation
+/// > Translation
+SDL_Point get_translation();
+
 /// Set darkness
 /// < enable Enable darkness
 /// < start Start depth value
@@ -0,0 +1,289 @@
+/// State history (source)
+/// (c) 2017 Jani Nykänen
+
+#include "history.h"
+
+#include "stdlib.h"
+#include "string.h"
+
+/// Delta word size
+#define WORD_SIZE ((int)sizeof(Uint32))
+/// Words compared at once when skipping unchanged parts
+#define BLOCK_WORDS 16
+/// Size of the length stored on both sides of a delta
+#define LEN_SIZE ((int)sizeof(Sint32))
+
+/// Write a variable-length number
+/// < p Output
+/// < v Number
+/// > End of the written bytes
+static Uint8* put_varint(Uint8* p, Uint32 v)
+{
+    while(v >= 0x80)
+    {
+        *(p ++) = (Uint8)(v | 0x80);
+        v >>= 7;
+    }
+    *(p ++) = (Uint8)v;
+
+    return p;
+}
+
+/// Read a variable-length number
+/// < p Input
+/// < v Number
+/// > End of the read bytes
+static const Uint8* get_varint(const Uint8* p, Uint32* v)
+{
+    int shift = 0;
+    *v = 0;
+    do
+    {
+        *v |= (Uint32)(*p & 0x7F) << shift;
+        shift += 7;
+    }
+    while(*(p ++) & 0x80);
+
+    return p;
+}
+
+/// Wrap an offset to the ring
+/// < h History
+/// < pos Offset
+/// > Offset in the ring
+static int wrap(HISTORY* h, int pos)
+{
+    pos %= h->ringSize;
+    return pos < 0 ? pos + h->ringSize : pos;
+}
+
+/// Write to the ring
+/// < h History
+/// < pos Offset
+/// < src Data
+/// < n Amount of bytes
+static void ring_write(HISTORY* h, int pos, const void* src, int n)
+{
+    int first = h->ringSize - pos;
+    if(first > n) first = n;
+
+    memcpy(h->ring + pos,src,first);
+    memcpy(h->ring,(const Uint8*)src + first,n - first);
+}
+
+/// Read from the ring
+/// < h History
+/// < pos Offset
+/// < dest Output
+/// < n Amount of bytes
+static void ring_read(HISTORY* h, int pos, void* dest, int n)
+{
+    int first = h->ringSize - pos;
+    if(first > n) first = n;
+
+    memcpy(dest,h->ring + pos,first);
+    memcpy((Uint8*)dest + first,h->ring,n - first);
+}
+
+/// Read a word
+/// < p Bytes
+/// > Word
+static Uint32 get_word(const Uint8* p)
+{
+    Uint32 v;
+    memcpy(&v,p,WORD_SIZE);
+    return v;
+}
+
+/// Encode the changes from the latest state to the scratch
+/// buffer as runs of unchanged words and xored words. The
+/// state is mostly 32-bit fields, so words keep the runs
+/// short and the loops fast
+/// < h History
+/// > Delta size in bytes
+static int encode_delta(HISTORY* h)
+{
+    Uint8* out = h->scratch;
+    const Uint8* next = h->next;
+    const Uint8* state = h->state;
+    int n = h->words;
+    int i = 0;
+    int last = 0;
+    int start,stop,k;
+    Uint32 x;
+
+    while(i < n)
+    {
+        // Most of the state stays the same, skip it a block at a time
+        if(i + BLOCK_WORDS <= n && memcmp(next + i*WORD_SIZE,state + i*WORD_SIZE,
+            BLOCK_WORDS*WORD_SIZE) == 0)
+        {
+            i += BLOCK_WORDS;
+            continue;
+        }
+
+        stop = i + BLOCK_WORDS < n ? i + BLOCK_WORDS : n;
+        while(i < stop && get_word(next + i*WORD_SIZE) == get_word(state + i*WORD_SIZE))
+            i ++;
+        if(i == stop) continue;
+
+        start = i;
+        while(i < n && get_word(next + i*WORD_SIZE) != get_word(state + i*WORD_SIZE))
+            i ++;
+
+        out = put_varint(out,(Uint32)(start - last));
+        out = put_varint(out,(Uint32)(i - start));
+        for(k=start; k < i; k++)
+        {
+            x = get_word(next + k*WORD_SIZE) ^ get_word(state + k*WORD_SIZE);
+            memcpy(out,&x,WORD_SIZE);
+            out += WORD_SIZE;
+        }
+        last = i;
+    }
+
+    return (int)(out - h->scratch);
+}
+
+/// Xor a delta to the latest state. The same delta takes
+/// the state either way
+/// < h History
+/// < d Delta
+/// < len Delta size in bytes
+static void apply_delta(HISTORY* h, const Uint8* d, int len)
+{
+    const Uint8* end = d + len;
+    Uint32 skip,n,k,x;
+    Uint8* p = h->state;
+
+    while(d < end)
+    {
+        d = get_varint(d,&skip);
+        d = get_varint(d,&n);
+        p += skip*WORD_SIZE;
+        for(k=0; k < n; k++)
+        {
+            x = get_word(p) ^ get_word(d);
+            memcpy(p,&x,WORD_SIZE);
+            p += WORD_SIZE;
+            d += WORD_SIZE;
+        }
+    }
+}
+
+/// Create a state history
+HISTORY* create_history(int stateSize, int ringSize)
+{
+    if(stateSize <= 0 || ringSize <= 0)
+    {
+        return NULL;
+    }
+
+    HISTORY* h = (HISTORY*)calloc(1,sizeof(HISTORY));
+    if(h == NULL)
+    {
+        return NULL;
+    }
+
+    h->size = stateSize;
+    h->words = (stateSize + WORD_SIZE-1) / WORD_SIZE;
+    h->ringSize = ringSize;
+
+    // The padding after the state stays zero
+    h->state = (Uint8*)calloc(h->words,WORD_SIZE);
+    h->next = (Uint8*)calloc(h->words,WORD_SIZE);
+    // Worst case: every other word changes
+    h->scratch = (Uint8*)malloc(h->words*(WORD_SIZE+5) + 16);
+    h->ring = (Uint8*)malloc(ringSize);
+    if(h->state == NULL || h->next == NULL || h->scratch == NULL || h->ring == NULL)
+    {
+        destroy_history(h);
+        return NULL;
+    }
+
+    return h;
+}
+
+/// Forget the stored deltas and start from a state
+void hist_reset(HISTORY* h, const Uint8* state)
+{
+    memcpy(h->state,state,h->size);
+    h->head = 0;
+    h->used = 0;
+    h->count = 0;
+}
+
+/// Store a new state
+int hist_push(HISTORY* h, const Uint8* state)
+{
+    Sint32 len;
+    int rec;
+    Sint32 old;
+    Uint8* p;
+
+    memcpy(h->next,state,h->size);
+    len = encode_delta(h);
+    rec = len + LEN_SIZE*2;
+
+    p = h->state;
+    h->state = h->next;
+    h->next = p;
+
+    if(rec > h->ringSize)
+    {
+        h->head = 0;
+        h->used = 0;
+        h->count = 0;
+        return 1;
+    }
+
+    // Drop the oldest deltas to make room
+    while(h->ringSize - h->used < rec)
+    {
+        ring_read(h,wrap(h,h->head - h->used),&old,LEN_SIZE);
+        h->used -= old + LEN_SIZE*2;
+        h->count --;
+    }
+
+    // The length on both sides lets the ring be read both ways
+    ring_write(h,h->head,&len,LEN_SIZE);
+    ring_write(h,wrap(h,h->head + LEN_SIZE),h->scratch,len);
+    ring_write(h,wrap(h,h->head + LEN_SIZE + len),&len,LEN_SIZE);
+    h->head = wrap(h,h->head + rec);
+    h->used += rec;
+    h->count ++;
+
+    return 0;
+}
+
+/// Go back to older states
+int hist_rewind(HISTORY* h, int steps)
+{
+    Sint32 len;
+    int n = 0;
+
+    for(; n < steps && h->count > 0; n++)
+    {
+        ring_read(h,wrap(h,h->head - LEN_SIZE),&len,LEN_SIZE);
+        h->head = wrap(h,h->head - len - LEN_SIZE*2);
+        ring_read(h,wrap(h,h->head + LEN_SIZE),h->scratch,len);
+        apply_delta(h,h->scratch,len);
+
+        h->used -= len + LEN_SIZE*2;
+        h->count --;
+    }
+
+    return n;
+}
+
+/// Destroy a state history
+void destroy_history(HISTORY* h)
+{
+    if(h == NULL) return;
+
+    free(h->state);
+    free(h->next);
+    free(h->scratch);
+    free(h->ring);
+    free(h);
+}
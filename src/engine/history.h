@@ -0,0 +1,55 @@
+/// State history (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __HISTORY__
+#define __HISTORY__
+
+#include "SDL2/SDL.h"
+
+/// State history. The latest state is kept whole and older
+/// states as deltas against the next one, in a ring buffer
+/// where the oldest deltas make room for new ones
+typedef struct
+{
+    int size; /// State size in bytes
+    int words; /// State size in words, rounded up
+    Uint8* state; /// Latest state
+    Uint8* next; /// New state being stored
+    Uint8* scratch; /// Delta being encoded or decoded
+    Uint8* ring; /// Deltas
+    int ringSize; /// Ring size in bytes
+    int head; /// Write offset in the ring
+    int used; /// Bytes in use
+    int count; /// Stored deltas
+}
+HISTORY;
+
+/// Create a state history
+/// < stateSize State size in bytes
+/// < ringSize Delta buffer size in bytes
+/// > A new history, NULL on error
+HISTORY* create_history(int stateSize, int ringSize);
+
+/// Forget the stored deltas and start from a state
+/// < h History
+/// < state State
+void hist_reset(HISTORY* h, const Uint8* state);
+
+/// Store a new state
+/// < h History
+/// < state State
+/// > 0 on success, 1 if the delta did not fit and the older
+///   states were forgotten
+int hist_push(HISTORY* h, const Uint8* state);
+
+/// Go back to older states. The newer states are dropped
+/// < h History
+/// < steps Amount of states to go back
+/// > Amount of states gone back
+int hist_rewind(HISTORY* h, int steps);
+
+/// Destroy a state history
+/// < h History to destroy
+void destroy_history(HISTORY* h);
+
+#endif // __HISTORY__
@@ -7,78 +7,125 @@
 #include "stdbool.h"
 #include "stdlib.h"
 
-/// Maximum amount of words in a file
-#define MAX_WORDS 65535
+/// Initial word index capacity
+#define MIN_WORDS 64
 
+/// File contents, words are terminated in place
+static char* buffer;
 /// An array of words
-static WORD words [MAX_WORDS]; // No more words supported
-
+static WORD* words;
 /// Amount of words
 static unsigned int wordCount;
+/// Word array capacity
+static unsigned int wordCapacity;
+
+/// Read a whole file to the buffer
+/// < path File path
+/// > File size, -1 on error
+static long read_file(const char* path)
+{
+    FILE* f = fopen(path,"rb");
+    if(f == NULL)
+    {
+        printf("Failed to open a file in %s!\n",path);
+        return -1;
+    }
+
+    fseek(f,0,SEEK_END);
+    long len = ftell(f);
+    fseek(f,0,SEEK_SET);
+    if(len < 0)
+    {
+        fclose(f);
+        return -1;
+    }
+
+    free(buffer);
+    buffer = (char*)malloc(len+1);
+    if(buffer == NULL || fread(buffer,1,len,f) != (size_t)len)
+    {
+        printf("Failed to read a file in %s!\n",path);
+        fclose(f);
+        return -1;
+    }
+    buffer[len] = '\0';
+
+    fclose(f);
+
+    return len;
+}
+
+/// Add a word
+/// < start Word start
+/// < len Word length
+/// > 0 on success, 1 on error
+static int push_word(char* start, unsigned int len)
+{
+    if(wordCount >= wordCapacity)
+    {
+        unsigned int cap = wordCapacity == 0 ? MIN_WORDS : wordCapacity*2;
+        WORD* w = (WORD*)realloc(words,sizeof(WORD) * cap);
+        if(w == NULL)
+        {
+            printf("Memory allocation error!\n");
+            return 1;
+        }
+        words = w;
+        wordCapacity = cap;
+    }
+
+    start[len] = '\0';
+    words[wordCount].data = start;
+    words[wordCount].len = len;
+    wordCount ++;
+
+    return 0;
+}
 
 /// Parse file
 /// path File path
 /// Returns 0 if success, 1 if error
 static int parse_file(const char* path)
 {
-    // Open file
-    FILE* f = fopen(path,"r");
-    if(f == NULL)
+    long len = read_file(path);
+    if(len < 0)
     {
-        printf("Failed to open a file in %s!\n",path);
         return 1;
     }
 
-    // Initialize the first word
-    words[0].len = 0;
-
     // Go through characters
+    char* p = buffer;
+    char* end = buffer + len;
+    char* start = NULL;
     char ch;
-    bool ignore = false;
-    while ( (ch = fgetc(f)) != EOF)
+    for(; p < end; p++)
     {
-        // If comment, ignore until newline
-        if(ch == '#')
-        {
-            ignore = true;
-        }
+        ch = *p;
 
-        if(!ignore)
+        // Whitespace or a comment ends a word
+        if(ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t' || ch == '#')
         {
-            // If newline or space, move to the next word (if the word length is not 0)
-            if(words[wordCount].len != 0 && (ch == '\n' || ch == ' '))
+            if(start != NULL && push_word(start,(unsigned int)(p-start)) != 0)
             {
-                words[wordCount].data[words[wordCount].len] = '\0';
-
-                wordCount ++;
-                if(wordCount >= MAX_WORDS)
-                    wordCount = MAX_WORDS;
-
-                // Clear word
-                int i=0;
-                for(; i < 256; i++)
-                {
-                    words[wordCount].data[i] = 0;
-                }
-
-                words[wordCount].len = 0;
+                return 1;
             }
-            else
+            start = NULL;
+
+            // If comment, ignore until newline
+            if(ch == '#')
             {
-                words[wordCount].data[words[wordCount].len] = ch;
-                words[wordCount].len ++;
+                while(p+1 < end && p[1] != '\n') p++;
             }
         }
-        // If newline and comment, comment ends
-        else if(ignore && ch == '\n')
+        else if(start == NULL)
         {
-            ignore = false;
+            start = p;
         }
-
-        
     }
-
-    fclose(f);
+    if(start != NULL)
+    {
+        return push_word(start,(unsigned int)(p-start));
+    }
     
     return 0;
 }
@@ -104,9 +151,10 @@ unsigned int get_list_word_count()
 /// Returns a word in an index
 WORD get_list_word(unsigned int index)
 {
-    if(index > wordCount)
+    if(index >= wordCount)
     {
         WORD w;
+        w.data = "";
         w.len = 0;
         return w;
     }
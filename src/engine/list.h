@@ -6,11 +6,11 @@
 
 #include "SDL2/SDL.h"
 
-/// Word type
+/// Word type, a view to the loaded list
 typedef struct
 {
-    char data [256]; /// Word characters
-    Uint8 len; /// Word length
+    char* data; /// Word characters (null terminated)
+    unsigned int len; /// Word length
 }
 WORD;
 
@@ -23,9 +23,10 @@ int load_list(const char* path);
 /// > The word count
 unsigned int get_list_word_count();
 
-/// Returns a word in an index
+/// Returns a word in an index. The word stays valid
+/// until the next list is loaded
 /// < index Word index
 /// > Empty word (len=0) if index out of range
 WORD get_list_word(unsigned int index);
 
-#endif // __LIST__
\ No newline at end of file
+#endif // __LIST__
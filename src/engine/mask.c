@@ -0,0 +1,103 @@
+/// Collision mask (source)
+/// (c) 2017 Jani Nykänen
+
+#include "mask.h"
+
+#include "stdlib.h"
+
+/// Get up to 64 bits from a row
+/// < row Row
+/// < start First bit
+/// < n Bit count, 1-64
+/// > Bits
+static Uint64 get_bits(const Uint64* row, int start, int n)
+{
+    int w = start >> 6;
+    int sh = start & 63;
+
+    // The padding word makes the second read safe
+    Uint64 v = row[w] >> sh;
+    if(sh != 0)
+        v |= row[w+1] << (64 - sh);
+
+    return n == 64 ? v : v & ((1ULL << n) -1);
+}
+
+/// Create a collision mask
+MASK* create_mask(BITMAP* b)
+{
+    MASK* m = (MASK*)malloc(sizeof(MASK));
+    if(m == NULL)
+    {
+        return NULL;
+    }
+
+    m->w = b->w;
+    m->h = b->h;
+    m->words = (b->w + 63) / 64 + 1;
+    m->bits = (Uint64*)calloc(m->words * m->h,sizeof(Uint64));
+    if(m->bits == NULL)
+    {
+        free(m);
+        return NULL;
+    }
+
+    int x,y;
+    const Uint8* src;
+    Uint64* dst;
+    for(y=0; y < b->h; y++)
+    {
+        src = b->data + y*b->pitch;
+        dst = m->bits + y*m->words;
+        for(x=0; x < b->w; x++)
+        {
+            if(src[x] != 255)
+                dst[x >> 6] |= 1ULL << (x & 63);
+        }
+    }
+
+    return m;
+}
+
+/// Test if two mask regions overlap
+bool mask_overlap(MASK* a, SDL_Rect ra, int ax, int ay, MASK* b, SDL_Rect rb, int bx, int by)
+{
+    // Keep the regions inside the masks
+    if(ra.x < 0 || ra.y < 0 || ra.x + ra.w > a->w || ra.y + ra.h > a->h
+        || rb.x < 0 || rb.y < 0 || rb.x + rb.w > b->w || rb.y + rb.h > b->h)
+        return false;
+
+    // Overlapping area
+    int x0 = ax > bx ? ax : bx;
+    int y0 = ay > by ? ay : by;
+    int x1 = ax+ra.w < bx+rb.w ? ax+ra.w : bx+rb.w;
+    int y1 = ay+ra.h < by+rb.h ? ay+ra.h : by+rb.h;
+    if(x1 <= x0 || y1 <= y0)
+        return false;
+
+    const Uint64* rowA;
+    const Uint64* rowB;
+    int y,x,n;
+    for(y=y0; y < y1; y++)
+    {
+        rowA = a->bits + (ra.y + y - ay) * a->words;
+        rowB = b->bits + (rb.y + y - by) * b->words;
+        for(x=x0; x < x1; x += 64)
+        {
+            n = x1-x < 64 ? x1-x : 64;
+            if(get_bits(rowA,ra.x + x - ax,n) & get_bits(rowB,rb.x + x - bx,n))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+/// Destroy a mask
+void destroy_mask(MASK* m)
+{
+    if(m == NULL) return;
+
+    free(m->bits);
+    free(m);
+}
@@ -0,0 +1,42 @@
+/// Collision mask (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __MASK__
+#define __MASK__
+
+#include "bitmap.h"
+
+#include "stdbool.h"
+
+/// Collision mask, one bit per opaque pixel
+typedef struct
+{
+    int w; /// Width
+    int h; /// Height
+    int words; /// 64-bit words per row, with one for padding
+    Uint64* bits; /// Rows of bits, pixel x is bit x%64 of word x/64
+}
+MASK;
+
+/// Create a collision mask from the color key of a bitmap
+/// < b Bitmap
+/// > A new mask, NULL on error
+MASK* create_mask(BITMAP* b);
+
+/// Test if two mask regions overlap
+/// < a Mask 1
+/// < ra Source region in mask 1
+/// < ax X coordinate of region 1
+/// < ay Y coordinate of region 1
+/// < b Mask 2
+/// < rb Source region in mask 2
+/// < bx X coordinate of region 2
+/// < by Y coordinate of region 2
+/// > True if an opaque pixel overlaps another
+bool mask_overlap(MASK* a, SDL_Rect ra, int ax, int ay, MASK* b, SDL_Rect rb, int bx, int by);
+
+/// Destroy a mask
+/// < m Mask to destroy
+void destroy_mask(MASK* m);
+
+#endif // __MASK__
@@ -0,0 +1,167 @@
+/// Asset pack (source)
+/// (c) 2017 Jani Nykänen
+
+#include "pack.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#ifdef _WIN32
+#define PACK_NO_MMAP
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/// Pack data
+static Uint8* packData;
+/// Pack size
+static size_t packSize;
+/// Entries
+static PACK_ENTRY* entries;
+/// Entry count
+static unsigned int entryCount;
+
+/// Map (or read) a file to memory
+/// < path File path
+/// > 0 on success, 1 on error
+static int pack_map_file(const char* path)
+{
+#ifdef PACK_NO_MMAP
+    FILE* f = fopen(path,"rb");
+    if(f == NULL)
+    {
+        return 1;
+    }
+
+    fseek(f,0,SEEK_END);
+    long len = ftell(f);
+    fseek(f,0,SEEK_SET);
+    if(len <= 0)
+    {
+        fclose(f);
+        return 1;
+    }
+
+    packData = (Uint8*)malloc(len);
+    if(packData == NULL || fread(packData,1,len,f) != (size_t)len)
+    {
+        free(packData);
+        packData = NULL;
+        fclose(f);
+        return 1;
+    }
+    packSize = (size_t)len;
+    fclose(f);
+#else
+    int fd = open(path,O_RDONLY);
+    if(fd < 0)
+    {
+        return 1;
+    }
+
+    struct stat st;
+    if(fstat(fd,&st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return 1;
+    }
+
+    void* p = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if(p == MAP_FAILED)
+    {
+        return 1;
+    }
+    packData = (Uint8*)p;
+    packSize = (size_t)st.st_size;
+#endif
+
+    return 0;
+}
+
+/// Open an asset pack
+int pack_open(const char* path)
+{
+    pack_close();
+
+    if(pack_map_file(path) != 0)
+    {
+        return 1;
+    }
+
+    // Validate header & entries
+    PACK_HEADER* head = (PACK_HEADER*)packData;
+    if(packSize < sizeof(PACK_HEADER) || head->magic != PACK_MAGIC || head->version != PACK_VERSION
+       || head->count > (packSize - sizeof(PACK_HEADER)) / sizeof(PACK_ENTRY))
+    {
+        printf("Invalid asset pack in %s!\n",path);
+        pack_close();
+        return 1;
+    }
+
+    entries = (PACK_ENTRY*)(packData + sizeof(PACK_HEADER));
+    int i = 0;
+    for(; i < head->count; i++)
+    {
+        PACK_ENTRY* e = &entries[i];
+        if(e->size != e->w * e->h || e->offset > packSize || e->size > packSize - e->offset
+           || memchr(e->name,'\0',sizeof(e->name)) == NULL)
+        {
+            printf("Invalid asset pack entry in %s!\n",path);
+            pack_close();
+            return 1;
+        }
+    }
+    entryCount = head->count;
+
+    return 0;
+}
+
+/// Return the entry count of the opened pack
+unsigned int pack_get_count()
+{
+    return entryCount;
+}
+
+/// Return the name of an entry
+const char* pack_get_name(unsigned int index)
+{
+    if(index >= entryCount) return NULL;
+
+    return entries[index].name;
+}
+
+/// Return a bitmap pointing to the pack data
+BITMAP pack_get_bitmap(unsigned int index)
+{
+    BITMAP b = {0,0,NULL,0};
+    if(index >= entryCount) return b;
+
+    b.w = entries[index].w;
+    b.h = entries[index].h;
+    b.pitch = entries[index].w;
+    b.data = packData + entries[index].offset;
+
+    return b;
+}
+
+/// Close the opened pack
+void pack_close()
+{
+    if(packData == NULL) return;
+
+#ifdef PACK_NO_MMAP
+    free(packData);
+#else
+    munmap(packData,packSize);
+#endif
+
+    packData = NULL;
+    packSize = 0;
+    entries = NULL;
+    entryCount = 0;
+}
@@ -0,0 +1,61 @@
+/// Asset pack (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __PACK__
+#define __PACK__
+
+#include "SDL2/SDL.h"
+
+#include "bitmap.h"
+
+/// Pack magic ("PACK")
+#define PACK_MAGIC 0x4B434150
+/// Pack format version
+#define PACK_VERSION 1
+/// Alignment of bitmap data in a pack
+#define PACK_ALIGN 64
+
+/// Pack header
+typedef struct
+{
+    Uint32 magic; /// Magic number
+    Uint32 version; /// Format version
+    Uint32 count; /// Amount of entries
+    Uint32 reserved; /// Reserved, zero
+}
+PACK_HEADER;
+
+/// Pack entry, the entries follow the header
+typedef struct
+{
+    char name[64]; /// Asset name
+    Uint32 w; /// Bitmap width
+    Uint32 h; /// Bitmap height
+    Uint32 offset; /// Data offset from the beginning of the file
+    Uint32 size; /// Data size in bytes
+}
+PACK_ENTRY;
+
+/// Open an asset pack
+/// < path Pack path
+/// > 0 on success, 1 on error
+int pack_open(const char* path);
+
+/// Return the entry count of the opened pack
+/// > Entry count
+unsigned int pack_get_count();
+
+/// Return the name of an entry
+/// < index Entry index
+/// > Entry name
+const char* pack_get_name(unsigned int index);
+
+/// Return a bitmap pointing to the pack data
+/// < index Entry index
+/// > Bitmap
+BITMAP pack_get_bitmap(unsigned int index);
+
+/// Close the opened pack
+void pack_close();
+
+#endif // __PACK__
@@ -0,0 +1,131 @@
+/// Parallax layer (source)
+/// (c) 2017 Jani Nykänen
+
+#include "parallax.h"
+
+#include "graphics.h"
+
+#include "stdlib.h"
+#include "string.h"
+
+/// Copy a row segment, skipping transparent pixels
+/// < dst Destination
+/// < src Source
+/// < len Length
+static void copy_keyed(Uint8* dst, const Uint8* src, int len)
+{
+    int i = 0;
+    for(; i < len; i++)
+    {
+        if(src[i] != 255) dst[i] = src[i];
+    }
+}
+
+/// Compose a layer
+PARALLAX* create_parallax(BITMAP* b, int sx, int sy, int sw, int sh, int minWidth)
+{
+    if(b == NULL || sw <= 0 || sh <= 0)
+    {
+        return NULL;
+    }
+
+    PARALLAX* p = (PARALLAX*)malloc(sizeof(PARALLAX));
+    if(p == NULL)
+    {
+        return NULL;
+    }
+
+    // Wide enough to cover the frame with two copies per row
+    p->w = (minWidth + sw-1) / sw * sw;
+    if(p->w < sw) p->w = sw;
+    p->h = sh;
+    p->data = (Uint8*)malloc(p->w * p->h);
+    p->rowType = (Uint8*)malloc(p->h);
+    if(p->data == NULL || p->rowType == NULL)
+    {
+        destroy_parallax(p);
+        return NULL;
+    }
+    p->source = b->data + sy*b->pitch + sx;
+
+    int x,y;
+    Uint8* row;
+    for(y=0; y < sh; y++)
+    {
+        row = p->data + y*p->w;
+        for(x=0; x < p->w; x += sw)
+        {
+            memcpy(row + x,p->source + y*b->pitch,sw);
+        }
+
+        if(memchr(row,255,sw) == NULL)
+            p->rowType[y] = ROW_OPAQUE;
+        else
+        {
+            p->rowType[y] = ROW_TRANSPARENT;
+            for(x=0; x < sw && p->rowType[y] == ROW_TRANSPARENT; x++)
+            {
+                if(row[x] != 255) p->rowType[y] = ROW_MIXED;
+            }
+        }
+    }
+
+    return p;
+}
+
+/// Check if a layer is up to date
+bool parallax_is_current(PARALLAX* p, BITMAP* b, int sx, int sy)
+{
+    return p != NULL && b != NULL && p->source == b->data + sy*b->pitch + sx;
+}
+
+/// Draw a layer
+void draw_parallax(PARALLAX* p, int scroll, int dy)
+{
+    FRAME* fr = get_current_frame();
+
+    int off = scroll % p->w;
+    if(off < 0) off += p->w;
+
+    // The strip from the offset, then wrapped to its start
+    int len1 = p->w - off;
+    if(len1 > fr->w) len1 = fr->w;
+    int len2 = fr->w - len1;
+
+    int y = dy < 0 ? -dy : 0;
+    int y1 = dy + p->h > fr->h ? fr->h - dy : p->h;
+
+    const Uint8* src;
+    Uint8* dst;
+    for(; y < y1; y++)
+    {
+        src = p->data + y*p->w;
+        dst = fr->colorData + (dy+y)*fr->pitch;
+
+        switch(p->rowType[y])
+        {
+        case ROW_OPAQUE:
+            memcpy(dst,src + off,len1);
+            memcpy(dst + len1,src,len2);
+            break;
+
+        case ROW_MIXED:
+            copy_keyed(dst,src + off,len1);
+            copy_keyed(dst + len1,src,len2);
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+/// Destroy a layer
+void destroy_parallax(PARALLAX* p)
+{
+    if(p == NULL) return;
+
+    free(p->data);
+    free(p->rowType);
+    free(p);
+}
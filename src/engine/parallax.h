@@ -0,0 +1,59 @@
+/// Parallax layer (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __PARALLAX__
+#define __PARALLAX__
+
+#include "bitmap.h"
+
+#include "stdbool.h"
+
+/// Row types
+enum
+{
+    ROW_TRANSPARENT = 0,
+    ROW_MIXED = 1,
+    ROW_OPAQUE = 2,
+};
+
+/// Horizontally repeating layer
+typedef struct
+{
+    int w; /// Strip width, a multiple of the source width
+    int h; /// Height
+    Uint8* data; /// Strip pixels
+    Uint8* rowType; /// Row types
+    const Uint8* source; /// Source pixels the strip was made from
+}
+PARALLAX;
+
+/// Compose a repeating bitmap region into a wrap-around strip
+/// < b Bitmap
+/// < sx Source X
+/// < sy Source Y
+/// < sw Source W, the repeating period
+/// < sh Source H
+/// < minWidth Minimum strip width, usually the frame width
+/// > A new layer, NULL on error
+PARALLAX* create_parallax(BITMAP* b, int sx, int sy, int sw, int sh, int minWidth);
+
+/// Check if a layer was composed from the current pixels of a bitmap.
+/// Reloaded bitmaps get new pixel data
+/// < p Layer
+/// < b Bitmap
+/// < sx Source X
+/// < sy Source Y
+/// > True if up to date
+bool parallax_is_current(PARALLAX* p, BITMAP* b, int sx, int sy);
+
+/// Draw a layer across the current frame
+/// < p Layer
+/// < scroll Horizontal scroll in pixels, any value
+/// < dy Y coordinate
+void draw_parallax(PARALLAX* p, int scroll, int dy);
+
+/// Destroy a layer
+/// < p Layer to destroy
+void destroy_parallax(PARALLAX* p);
+
+#endif // __PARALLAX__
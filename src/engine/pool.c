@@ -0,0 +1,177 @@
+/// Entity pool (source)
+/// (c) 2017 Jani Nykänen
+
+#include "pool.h"
+#include "state.h"
+
+#include "stdlib.h"
+#include "string.h"
+
+/// Create an entity pool
+POOL* create_pool(int capacity, int coldSize)
+{
+    if(capacity <= 0 || coldSize < 0)
+    {
+        return NULL;
+    }
+
+    POOL* p = (POOL*)calloc(1,sizeof(POOL));
+    if(p == NULL)
+    {
+        return NULL;
+    }
+
+    p->capacity = capacity;
+    p->coldSize = coldSize;
+    p->x = (FIXED*)calloc(capacity,sizeof(FIXED));
+    p->y = (FIXED*)calloc(capacity,sizeof(FIXED));
+    p->vx = (FIXED*)calloc(capacity,sizeof(FIXED));
+    p->vy = (FIXED*)calloc(capacity,sizeof(FIXED));
+    p->phase = (FIXED*)calloc(capacity,sizeof(FIXED));
+    p->wave = (FIXED*)calloc(capacity,sizeof(FIXED));
+    p->type = (int*)calloc(capacity,sizeof(int));
+    p->alive = (bool*)calloc(capacity,sizeof(bool));
+    p->live = (int*)calloc(capacity,sizeof(int));
+    p->liveIndex = (int*)calloc(capacity,sizeof(int));
+    p->freeSlots = (int*)calloc(capacity,sizeof(int));
+    p->cold = (Uint8*)calloc(capacity,coldSize > 0 ? coldSize : 1);
+
+    if(p->x == NULL || p->y == NULL || p->vx == NULL || p->vy == NULL
+        || p->phase == NULL || p->wave == NULL || p->type == NULL || p->alive == NULL || p->live == NULL
+        || p->liveIndex == NULL || p->freeSlots == NULL || p->cold == NULL)
+    {
+        destroy_pool(p);
+        return NULL;
+    }
+
+    pool_clear(p);
+
+    return p;
+}
+
+/// Spawn an entity
+int pool_spawn(POOL* p, int type)
+{
+    if(p->freeCount == 0)
+        return -1;
+
+    int slot = p->freeSlots[-- p->freeCount];
+
+    p->x[slot] = 0;
+    p->y[slot] = 0;
+    p->vx[slot] = 0;
+    p->vy[slot] = 0;
+    p->phase[slot] = 0;
+    p->type[slot] = type;
+    p->alive[slot] = true;
+
+    p->liveIndex[slot] = p->count;
+    p->live[p->count ++] = slot;
+
+    return slot;
+}
+
+/// Despawn an entity
+void pool_despawn(POOL* p, int slot)
+{
+    if(slot < 0 || slot >= p->capacity || !p->alive[slot])
+        return;
+
+    // Move the last live slot to the hole
+    int i = p->liveIndex[slot];
+    int last = p->live[-- p->count];
+    p->live[i] = last;
+    p->liveIndex[last] = i;
+
+    p->alive[slot] = false;
+    p->freeSlots[p->freeCount ++] = slot;
+}
+
+/// Despawn every entity
+void pool_clear(POOL* p)
+{
+    int i = 0;
+    for(; i < p->capacity; i++)
+    {
+        p->alive[i] = false;
+
+        // Lowest slots are taken first
+        p->freeSlots[i] = p->capacity-1 - i;
+    }
+    p->freeCount = p->capacity;
+    p->count = 0;
+}
+
+/// Get the cold data of a slot
+void* pool_cold(POOL* p, int slot)
+{
+    return (void*)(p->cold + (size_t)slot * p->coldSize);
+}
+
+/// Get the size of the pool state
+int pool_state_size(POOL* p)
+{
+    int n = p->capacity;
+    return (int)(sizeof(int)*2 + sizeof(FIXED)*5*n + sizeof(int)*n
+        + sizeof(bool)*n + sizeof(int)*3*n) + p->coldSize*n;
+}
+
+/// Save the pool state
+Uint8* pool_save(POOL* p, Uint8* out)
+{
+    int n = p->capacity;
+
+    out = save_bytes(out,&p->count,sizeof(int));
+    out = save_bytes(out,&p->freeCount,sizeof(int));
+    out = save_bytes(out,p->x,sizeof(FIXED)*n);
+    out = save_bytes(out,p->y,sizeof(FIXED)*n);
+    out = save_bytes(out,p->vx,sizeof(FIXED)*n);
+    out = save_bytes(out,p->vy,sizeof(FIXED)*n);
+    out = save_bytes(out,p->phase,sizeof(FIXED)*n);
+    out = save_bytes(out,p->type,sizeof(int)*n);
+    out = save_bytes(out,p->alive,sizeof(bool)*n);
+    out = save_bytes(out,p->live,sizeof(int)*n);
+    out = save_bytes(out,p->liveIndex,sizeof(int)*n);
+    out = save_bytes(out,p->freeSlots,sizeof(int)*n);
+    return save_bytes(out,p->cold,p->coldSize*n);
+}
+
+/// Load the pool state
+const Uint8* pool_load(POOL* p, const Uint8* in)
+{
+    int n = p->capacity;
+
+    in = load_bytes(in,&p->count,sizeof(int));
+    in = load_bytes(in,&p->freeCount,sizeof(int));
+    in = load_bytes(in,p->x,sizeof(FIXED)*n);
+    in = load_bytes(in,p->y,sizeof(FIXED)*n);
+    in = load_bytes(in,p->vx,sizeof(FIXED)*n);
+    in = load_bytes(in,p->vy,sizeof(FIXED)*n);
+    in = load_bytes(in,p->phase,sizeof(FIXED)*n);
+    in = load_bytes(in,p->type,sizeof(int)*n);
+    in = load_bytes(in,p->alive,sizeof(bool)*n);
+    in = load_bytes(in,p->live,sizeof(int)*n);
+    in = load_bytes(in,p->liveIndex,sizeof(int)*n);
+    in = load_bytes(in,p->freeSlots,sizeof(int)*n);
+    return load_bytes(in,p->cold,p->coldSize*n);
+}
+
+/// Destroy a pool
+void destroy_pool(POOL* p)
+{
+    if(p == NULL) return;
+
+    free(p->x);
+    free(p->y);
+    free(p->vx);
+    free(p->vy);
+    free(p->phase);
+    free(p->wave);
+    free(p->type);
+    free(p->alive);
+    free(p->live);
+    free(p->liveIndex);
+    free(p->freeSlots);
+    free(p->cold);
+    free(p);
+}
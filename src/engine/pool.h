@@ -0,0 +1,89 @@
+/// Entity pool (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __POOL__
+#define __POOL__
+
+#include "SDL2/SDL.h"
+
+#include "fixed.h"
+
+#include "stdbool.h"
+
+/// Entity pool. Fields used every frame are kept in separate
+/// arrays, the rest is stored per slot as cold data
+typedef struct
+{
+    int capacity; /// Slot count
+    int count; /// Live entity count
+
+    FIXED* x; /// X coordinates
+    FIXED* y; /// Y coordinates
+    FIXED* vx; /// Horizontal speeds
+    FIXED* vy; /// Vertical speeds
+    FIXED* phase; /// Wave phases in radians
+    FIXED* wave; /// Scratch for batched wave math, not part of the state
+    int* type; /// Entity types
+    bool* alive; /// Is the slot in use
+
+    int* live; /// Live slots, densely packed
+    int* liveIndex; /// Index of each live slot in the live list
+    int* freeSlots; /// Free slot stack
+    int freeCount; /// Free slot count
+
+    Uint8* cold; /// Cold data
+    int coldSize; /// Cold data size per slot in bytes
+}
+POOL;
+
+/// Create an entity pool
+/// < capacity Slot count
+/// < coldSize Cold data size per slot in bytes
+/// > A new pool, NULL on error
+POOL* create_pool(int capacity, int coldSize);
+
+/// Spawn an entity. Hot fields are zeroed
+/// < p Pool
+/// < type Entity type
+/// > Slot index, -1 if the pool is full
+int pool_spawn(POOL* p, int type);
+
+/// Despawn an entity. The last live entity takes its
+/// place in the live list, so iterate the list backwards
+/// when despawning during iteration
+/// < p Pool
+/// < slot Slot index
+void pool_despawn(POOL* p, int slot);
+
+/// Despawn every entity
+/// < p Pool
+void pool_clear(POOL* p);
+
+/// Get the cold data of a slot
+/// < p Pool
+/// < slot Slot index
+/// > Cold data
+void* pool_cold(POOL* p, int slot);
+
+/// Get the size of the pool state
+/// < p Pool
+/// > Size in bytes
+int pool_state_size(POOL* p);
+
+/// Save the pool state
+/// < p Pool
+/// < out Output, at least pool_state_size bytes
+/// > End of the written state
+Uint8* pool_save(POOL* p, Uint8* out);
+
+/// Load a state saved from a pool of the same capacity
+/// < p Pool
+/// < in Input
+/// > End of the read state
+const Uint8* pool_load(POOL* p, const Uint8* in);
+
+/// Destroy a pool
+/// < p Pool to destroy
+void destroy_pool(POOL* p);
+
+#endif // __POOL__
@@ -0,0 +1,139 @@
+/// Random number generator (source)
+/// (c) 2017 Jani Nykänen
+
+#include "rng.h"
+
+/// Generators run side by side in rng_fill
+#define FILL_LANES 8
+/// Smallest buffer worth seeding the side generators for
+#define FILL_MIN 64
+
+/// Rotate left
+/// < x Number
+/// < k Bits
+/// > Rotated number
+static Uint32 rotl(Uint32 x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+/// Expand a seed to state words (splitmix32)
+/// < x Seed, advanced
+/// > State word
+static Uint32 split_mix(Uint32* x)
+{
+    Uint32 z = (*x += 0x9E3779B9);
+    z = (z ^ (z >> 16)) * 0x85EBCA6B;
+    z = (z ^ (z >> 13)) * 0xC2B2AE35;
+    return z ^ (z >> 16);
+}
+
+/// Seed a generator
+void rng_seed(RNG* r, Uint32 seed)
+{
+    int i = 0;
+    for(; i < 4; i++)
+    {
+        r->s[i] = split_mix(&seed);
+    }
+
+    // Xoshiro never leaves the zero state
+    if((r->s[0] | r->s[1] | r->s[2] | r->s[3]) == 0)
+        r->s[0] = 1;
+}
+
+/// Next random number
+Uint32 rng_next(RNG* r)
+{
+    Uint32* s = r->s;
+    Uint32 out = rotl(s[1] * 5,7) * 9;
+    Uint32 t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3],11);
+
+    return out;
+}
+
+/// Random integer
+int rng_int(RNG* r, int max)
+{
+    if(max <= 0) return 0;
+
+    // Scale to the range with a multiply and reject the
+    // few numbers that would make some results more likely
+    Uint32 bound = (Uint32)max;
+    Uint64 m = (Uint64)rng_next(r) * bound;
+    Uint32 low = (Uint32)m;
+    if(low < bound)
+    {
+        Uint32 limit = (0u - bound) % bound;
+        while(low < limit)
+        {
+            m = (Uint64)rng_next(r) * bound;
+            low = (Uint32)m;
+        }
+    }
+
+    return (int)(m >> 32);
+}
+
+/// Random float
+float rng_float(RNG* r)
+{
+    return (float)(rng_next(r) >> 8) * (1.0f / 16777216.0f);
+}
+
+/// Random float in a range
+float rng_range(RNG* r, float min, float max)
+{
+    return min + rng_float(r) * (max - min);
+}
+
+/// Fill a buffer with random numbers
+void rng_fill(RNG* r, Uint32* out, int n)
+{
+    Uint32 s0[FILL_LANES], s1[FILL_LANES], s2[FILL_LANES], s3[FILL_LANES];
+    Uint32 t;
+    int i = 0;
+    int l;
+
+    if(n < FILL_MIN)
+    {
+        for(; i < n; i++)
+            out[i] = rng_next(r);
+        return;
+    }
+
+    for(l=0; l < FILL_LANES; l++)
+    {
+        s0[l] = rng_next(r);
+        s1[l] = rng_next(r);
+        s2[l] = rng_next(r);
+        s3[l] = rng_next(r) | 1;
+    }
+
+    // The lanes are independent, so the inner loop vectorizes
+    for(; i + FILL_LANES <= n; i += FILL_LANES)
+    {
+        for(l=0; l < FILL_LANES; l++)
+        {
+            out[i+l] = rotl(s1[l] * 5,7) * 9;
+            t = s1[l] << 9;
+
+            s2[l] ^= s0[l];
+            s3[l] ^= s1[l];
+            s1[l] ^= s2[l];
+            s0[l] ^= s3[l];
+            s2[l] ^= t;
+            s3[l] = rotl(s3[l],11);
+        }
+    }
+
+    for(; i < n; i++)
+        out[i] = rng_next(r);
+}
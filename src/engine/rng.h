@@ -0,0 +1,55 @@
+/// Random number generator (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __RNG__
+#define __RNG__
+
+#include "SDL2/SDL.h"
+
+/// Random number generator state, xoshiro128**. Each world
+/// owns one, so the same seed always gives the same sequence
+/// and worlds in different threads share nothing
+typedef struct
+{
+    Uint32 s[4];
+}
+RNG;
+
+/// Seed a generator
+/// < r Generator
+/// < seed Seed
+void rng_seed(RNG* r, Uint32 seed);
+
+/// Next random number
+/// < r Generator
+/// > A number in [0, 2^32)
+Uint32 rng_next(RNG* r);
+
+/// Random integer, without the bias of a modulo
+/// < r Generator
+/// < max Upper bound, exclusive
+/// > A number in [0, max)
+int rng_int(RNG* r, int max);
+
+/// Random float
+/// < r Generator
+/// > A number in [0, 1)
+float rng_float(RNG* r);
+
+/// Random float in a range
+/// < r Generator
+/// < min Lower bound
+/// < max Upper bound, exclusive
+/// > A number in [min, max)
+float rng_range(RNG* r, float min, float max);
+
+/// Fill a buffer with random numbers, for particles and
+/// other bulk uses. Large buffers are filled by generators
+/// seeded from this one, so the numbers differ from those
+/// of rng_next but are as reproducible
+/// < r Generator
+/// < out Output
+/// < n Amount of numbers
+void rng_fill(RNG* r, Uint32* out, int n);
+
+#endif // __RNG__
@@ -0,0 +1,293 @@
+/// Event scheduler (source)
+/// (c) 2017 Jani Nykänen
+
+#include "sched.h"
+#include "state.h"
+
+#include "stdlib.h"
+
+/// Event states
+enum
+{
+    EV_FREE = 0,
+    EV_PENDING = 1,
+    EV_FIRING = 2,
+};
+
+/// Slot mask
+#define SLOT_MASK (SCHED_SLOTS-1)
+
+/// Make an event id
+/// < i Event index
+/// < gen Generation
+#define make_id(i,gen) ((int)(((gen) & 0x7FFF) << 16) | (i))
+
+/// Slot of a due tick on a level
+/// < due Due tick
+/// < level Level
+static int slot_of(Uint32 due, int level)
+{
+    return (int)(due >> (SCHED_BITS*level)) & SLOT_MASK;
+}
+
+/// Link an event to its slot
+/// < s Scheduler
+/// < i Event index
+static void link_event(SCHEDULER* s, int i)
+{
+    SCHED_EVENT* e = &s->events[i];
+    Uint32 delta = e->due - s->now;
+
+    // The further away, the coarser the level
+    int level = 0;
+    while(level < SCHED_LEVELS-1 && delta >= (1u << (SCHED_BITS*(level+1))))
+        level ++;
+
+    int* head = &s->slots[level][slot_of(e->due,level)];
+    e->level = (Uint8)level;
+    e->prev = -1;
+    e->next = *head;
+    if(*head != -1)
+        s->events[*head].prev = i;
+    *head = i;
+}
+
+/// Unlink an event from its slot
+/// < s Scheduler
+/// < i Event index
+static void unlink_event(SCHEDULER* s, int i)
+{
+    SCHED_EVENT* e = &s->events[i];
+
+    if(e->prev != -1)
+        s->events[e->prev].next = e->next;
+    else
+        s->slots[e->level][slot_of(e->due,e->level)] = e->next;
+
+    if(e->next != -1)
+        s->events[e->next].prev = e->prev;
+}
+
+/// Free an event
+/// < s Scheduler
+/// < i Event index
+static void free_event(SCHEDULER* s, int i)
+{
+    SCHED_EVENT* e = &s->events[i];
+    e->state = EV_FREE;
+    e->gen ++;
+    e->next = s->freeList;
+    s->freeList = i;
+}
+
+/// Move the events of a coarse slot to finer levels
+/// < s Scheduler
+/// < level Level
+/// < slot Slot
+static void cascade(SCHEDULER* s, int level, int slot)
+{
+    int i = s->slots[level][slot];
+    int next;
+    s->slots[level][slot] = -1;
+
+    for(; i != -1; i = next)
+    {
+        next = s->events[i].next;
+        link_event(s,i);
+    }
+}
+
+/// Fire the events of the current tick
+/// < s Scheduler
+/// < fire Callback
+/// < user User data
+static void fire_tick(SCHEDULER* s, SCHED_FUNC fire, void* user)
+{
+    int slot = s->now & SLOT_MASK;
+    int i = s->slots[0][slot];
+    int n = 0;
+    int k,j,b;
+    SCHED_EVENT* e;
+    s->slots[0][slot] = -1;
+
+    // Detach the slot, since callbacks may add events
+    for(; i != -1; i = s->events[i].next)
+    {
+        s->events[i].state = EV_FIRING;
+        s->batch[n ++] = i;
+    }
+
+    // Scheduling order, the slot order depends on cascading
+    for(k=1; k < n; k++)
+    {
+        b = s->batch[k];
+        for(j=k; j > 0 && s->events[s->batch[j-1]].seq > s->events[b].seq; j--)
+            s->batch[j] = s->batch[j-1];
+        s->batch[j] = b;
+    }
+
+    for(k=0; k < n; k++)
+    {
+        e = &s->events[s->batch[k]];
+
+        // Cancelled by an earlier callback
+        if(e->state != EV_FIRING) continue;
+
+        int type = e->type;
+        int data = e->data;
+        free_event(s,s->batch[k]);
+        fire(user,type,data);
+    }
+}
+
+/// Create a scheduler
+SCHEDULER* create_scheduler(int capacity)
+{
+    if(capacity <= 0 || capacity > 0xFFFF)
+    {
+        return NULL;
+    }
+
+    SCHEDULER* s = (SCHEDULER*)calloc(1,sizeof(SCHEDULER));
+    if(s == NULL)
+    {
+        return NULL;
+    }
+
+    s->capacity = capacity;
+    s->events = (SCHED_EVENT*)calloc(capacity,sizeof(SCHED_EVENT));
+    s->batch = (int*)malloc(sizeof(int) * capacity);
+    if(s->events == NULL || s->batch == NULL)
+    {
+        destroy_scheduler(s);
+        return NULL;
+    }
+
+    sched_clear(s);
+
+    return s;
+}
+
+/// Schedule an event
+int sched_add(SCHEDULER* s, Uint32 delay, int type, int data)
+{
+    if(s->freeList == -1)
+        return -1;
+
+    if(delay < 1) delay = 1;
+    if(delay > SCHED_MAX_DELAY) delay = SCHED_MAX_DELAY;
+
+    int i = s->freeList;
+    SCHED_EVENT* e = &s->events[i];
+    s->freeList = e->next;
+
+    e->due = s->now + delay;
+    e->seq = s->seq ++;
+    e->type = type;
+    e->data = data;
+    e->state = EV_PENDING;
+    link_event(s,i);
+
+    return make_id(i,e->gen);
+}
+
+/// Cancel an event
+bool sched_cancel(SCHEDULER* s, int id)
+{
+    int i = id & 0xFFFF;
+    if(id < 0 || i >= s->capacity)
+        return false;
+
+    SCHED_EVENT* e = &s->events[i];
+    if(e->state == EV_FREE || make_id(i,e->gen) != id)
+        return false;
+
+    if(e->state == EV_PENDING)
+        unlink_event(s,i);
+    free_event(s,i);
+
+    return true;
+}
+
+/// Cancel every event
+void sched_clear(SCHEDULER* s)
+{
+    int i,k;
+    for(i=0; i < SCHED_LEVELS; i++)
+    {
+        for(k=0; k < SCHED_SLOTS; k++)
+            s->slots[i][k] = -1;
+    }
+
+    // Generations are kept, so old ids stay invalid
+    s->freeList = -1;
+    for(i=s->capacity-1; i >= 0; i--)
+    {
+        if(s->events[i].state != EV_FREE)
+            s->events[i].gen ++;
+        s->events[i].state = EV_FREE;
+        s->events[i].next = s->freeList;
+        s->freeList = i;
+    }
+
+    s->now = 0;
+    s->seq = 0;
+}
+
+/// Advance the scheduler
+void sched_advance(SCHEDULER* s, Uint32 ticks, SCHED_FUNC fire, void* user)
+{
+    int level;
+    for(; ticks > 0; ticks--)
+    {
+        s->now ++;
+
+        // Entering a new block of a level pulls its events down
+        for(level=1; level < SCHED_LEVELS; level++)
+        {
+            if((s->now & ((1u << (SCHED_BITS*level)) - 1)) != 0)
+                break;
+            
+            cascade(s,level,slot_of(s->now,level));
+        }
+
+        fire_tick(s,fire,user);
+    }
+}
+
+/// Get the size of the scheduler state
+int sched_state_size(SCHEDULER* s)
+{
+    return (int)(sizeof(SCHED_EVENT)*s->capacity + sizeof(int)
+        + sizeof(s->slots) + sizeof(Uint32)*2);
+}
+
+/// Save the scheduler state
+Uint8* sched_save(SCHEDULER* s, Uint8* out)
+{
+    out = save_bytes(out,s->events,sizeof(SCHED_EVENT)*s->capacity);
+    out = save_bytes(out,&s->freeList,sizeof(int));
+    out = save_bytes(out,s->slots,sizeof(s->slots));
+    out = save_bytes(out,&s->now,sizeof(Uint32));
+    return save_bytes(out,&s->seq,sizeof(Uint32));
+}
+
+/// Load the scheduler state
+const Uint8* sched_load(SCHEDULER* s, const Uint8* in)
+{
+    in = load_bytes(in,s->events,sizeof(SCHED_EVENT)*s->capacity);
+    in = load_bytes(in,&s->freeList,sizeof(int));
+    in = load_bytes(in,s->slots,sizeof(s->slots));
+    in = load_bytes(in,&s->now,sizeof(Uint32));
+    return load_bytes(in,&s->seq,sizeof(Uint32));
+}
+
+/// Destroy a scheduler
+void destroy_scheduler(SCHEDULER* s)
+{
+    if(s == NULL) return;
+
+    free(s->events);
+    free(s->batch);
+    free(s);
+}
@@ -0,0 +1,109 @@
+/// Event scheduler (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __SCHED__
+#define __SCHED__
+
+#include "SDL2/SDL.h"
+
+#include "stdbool.h"
+
+/// Wheel level count
+#define SCHED_LEVELS 4
+/// Slots per level, a power of two
+#define SCHED_SLOTS 64
+/// Bits per level
+#define SCHED_BITS 6
+/// Longest possible delay in ticks
+#define SCHED_MAX_DELAY ((1 << (SCHED_BITS*SCHED_LEVELS)) - 1)
+
+/// Event callback
+/// < user User data
+/// < type Event type
+/// < data Event data
+typedef void (*SCHED_FUNC) (void* user, int type, int data);
+
+/// Scheduled event
+typedef struct
+{
+    Uint32 due; /// Tick the event fires on
+    Uint32 seq; /// Order of scheduling
+    int type; /// Event type
+    int data; /// Event data
+    int prev; /// Previous event in the slot
+    int next; /// Next event in the slot, or the next free event
+    Uint16 gen; /// Generation, changed when the event is freed
+    Uint8 state; /// Free, pending or firing
+    Uint8 level; /// Wheel level
+}
+SCHED_EVENT;
+
+/// Hierarchical timing wheel. Advancing costs a constant
+/// amount per tick plus the events fired, however many
+/// events are pending
+typedef struct
+{
+    int capacity; /// Event capacity
+    SCHED_EVENT* events; /// Events
+    int freeList; /// First free event
+    int slots[SCHED_LEVELS][SCHED_SLOTS]; /// First event of each slot
+    Uint32 now; /// Current tick
+    Uint32 seq; /// Next scheduling order
+    int* batch; /// Events firing on the current tick
+}
+SCHEDULER;
+
+/// Create a scheduler
+/// < capacity Maximum amount of pending events
+/// > A new scheduler, NULL on error
+SCHEDULER* create_scheduler(int capacity);
+
+/// Schedule an event
+/// < s Scheduler
+/// < delay Ticks from now, at least 1
+/// < type Event type
+/// < data Event data
+/// > Event id, -1 if the scheduler is full
+int sched_add(SCHEDULER* s, Uint32 delay, int type, int data);
+
+/// Cancel an event
+/// < s Scheduler
+/// < id Event id
+/// > True if the event was pending
+bool sched_cancel(SCHEDULER* s, int id);
+
+/// Cancel every event
+/// < s Scheduler
+void sched_clear(SCHEDULER* s);
+
+/// Advance the scheduler. Events due on the same tick fire in
+/// the order they were scheduled. The callback may schedule
+/// and cancel events
+/// < s Scheduler
+/// < ticks Amount of ticks
+/// < fire Callback
+/// < user User data passed to the callback
+void sched_advance(SCHEDULER* s, Uint32 ticks, SCHED_FUNC fire, void* user);
+
+/// Get the size of the scheduler state
+/// < s Scheduler
+/// > Size in bytes
+int sched_state_size(SCHEDULER* s);
+
+/// Save the scheduler state
+/// < s Scheduler
+/// < out Output, at least sched_state_size bytes
+/// > End of the written state
+Uint8* sched_save(SCHEDULER* s, Uint8* out);
+
+/// Load a state saved from a scheduler of the same capacity
+/// < s Scheduler
+/// < in Input
+/// > End of the read state
+const Uint8* sched_load(SCHEDULER* s, const Uint8* in);
+
+/// Destroy a scheduler
+/// < s Scheduler to destroy
+void destroy_scheduler(SCHEDULER* s);
+
+#endif // __SCHED__
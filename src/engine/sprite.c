@@ -13,11 +13,11 @@
 /// Create a new sprite
 SPRITE create_sprite(int w, int h)
 {
-    return (SPRITE){w,h,0,0,0.0f};
+    return (SPRITE){w,h,0,0,0};
 }
 
 /// Animate a sprite
-void spr_animate(SPRITE*s, int row, int start, int end, float speed, float tm)
+void spr_animate(SPRITE*s, int row, int start, int end, FIXED speed, FIXED tm)
 {
     if(start == end)
     {
@@ -43,7 +43,7 @@ void spr_animate(SPRITE*s, int row, int start, int end, float speed, float tm)
         s->frame = end;
     }
 
-	s->count += 1.0f *tm;
+	s->count += tm;
 	if(s->count > speed)
     {
         if(start < end)
@@ -63,7 +63,8 @@ void spr_animate(SPRITE*s, int row, int start, int end, float speed, float tm)
             }
         }
 
-		s->count -= speed;
+		// With a non-positive speed the frame changes every step
+		s->count = speed > 0 ? s->count - speed : 0;
 	}
 }
 
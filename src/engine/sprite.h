@@ -5,6 +5,7 @@
 #define __SPRITE__
 
 #include "bitmap.h"
+#include "fixed.h"
 
 /// Sprite object
 typedef struct
@@ -13,7 +14,7 @@ typedef struct
     int h; /// Height
     int frame; /// Frame
     int row; /// Column
-    float count; /// Frame change count
+    FIXED count; /// Frame change count
 }
 SPRITE;
 
@@ -30,7 +31,7 @@ SPRITE create_sprite(int w, int h);
 /// < end Ending frame
 /// < speed Animation speed
 /// < tm Time multiplier
-void spr_animate(SPRITE*s, int row, int start, int end, float speed, float tm);
+void spr_animate(SPRITE*s, int row, int start, int end, FIXED speed, FIXED tm);
 
 /// Draw a sprite frame
 /// < s Sprite to draw
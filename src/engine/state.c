@@ -0,0 +1,20 @@
+/// Serialized state (source)
+/// (c) 2017 Jani Nykänen
+
+#include "state.h"
+
+#include "string.h"
+
+/// Copy to a state buffer
+Uint8* save_bytes(Uint8* out, const void* src, int n)
+{
+    memcpy(out,src,n);
+    return out + n;
+}
+
+/// Copy from a state buffer
+const Uint8* load_bytes(const Uint8* in, void* dest, int n)
+{
+    memcpy(dest,in,n);
+    return in + n;
+}
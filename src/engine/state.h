@@ -0,0 +1,23 @@
+/// Serialized state (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __STATE__
+#define __STATE__
+
+#include "SDL2/SDL.h"
+
+/// Copy to a state buffer
+/// < out Output
+/// < src Data
+/// < n Amount of bytes
+/// > End of the written bytes
+Uint8* save_bytes(Uint8* out, const void* src, int n);
+
+/// Copy from a state buffer
+/// < in Input
+/// < dest Output
+/// < n Amount of bytes
+/// > End of the read bytes
+const Uint8* load_bytes(const Uint8* in, void* dest, int n);
+
+#endif // __STATE__
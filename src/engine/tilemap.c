@@ -0,0 +1,465 @@
+/// Tilemap (source)
+/// (c) 2017 Jani Nykänen
+
+#include "tilemap.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "stdbool.h"
+
+#include <zlib.h>
+
+/// Maximum amount of layers
+#define MAX_LAYERS 16
+/// Maximum amount of attributes in a tag
+#define MAX_ATTRIBS 16
+/// Decoding chunk size in bytes
+#define DECODE_CHUNK 1024
+
+/// A view to a string in the file
+typedef struct
+{
+    const char* p; /// Start
+    int len; /// Length
+}
+VIEW;
+
+/// XML tag
+typedef struct
+{
+    VIEW name; /// Tag name
+    VIEW keys[MAX_ATTRIBS]; /// Attribute names
+    VIEW values[MAX_ATTRIBS]; /// Attribute values
+    int count; /// Attribute count
+    bool closing; /// Is a closing tag (</name>)
+    bool empty; /// Is an empty tag (<name/>)
+}
+TAG;
+
+/// Gid decoding state
+typedef struct
+{
+    Uint16* out; /// Output tiles
+    int count; /// Amount of tiles expected
+    int index; /// Tiles written
+    Uint32 acc; /// Gid being assembled
+    int shift; /// Bits in the gid so far
+}
+GID_STATE;
+
+/// Base64 values, -1 if not a base64 character
+static const signed char b64[256] = {
+    ['A']=0,['B']=1,['C']=2,['D']=3,['E']=4,['F']=5,['G']=6,['H']=7,['I']=8,['J']=9,
+    ['K']=10,['L']=11,['M']=12,['N']=13,['O']=14,['P']=15,['Q']=16,['R']=17,['S']=18,['T']=19,
+    ['U']=20,['V']=21,['W']=22,['X']=23,['Y']=24,['Z']=25,
+    ['a']=26,['b']=27,['c']=28,['d']=29,['e']=30,['f']=31,['g']=32,['h']=33,['i']=34,['j']=35,
+    ['k']=36,['l']=37,['m']=38,['n']=39,['o']=40,['p']=41,['q']=42,['r']=43,['s']=44,['t']=45,
+    ['u']=46,['v']=47,['w']=48,['x']=49,['y']=50,['z']=51,
+    ['0']=52,['1']=53,['2']=54,['3']=55,['4']=56,['5']=57,['6']=58,['7']=59,['8']=60,['9']=61,
+    ['+']=62,['/']=63,
+};
+
+/// Is a base64 character
+/// < c Character
+/// > True if base64
+static bool is_b64(char c)
+{
+    return c == 'A' || b64[(Uint8)c] != 0;
+}
+
+/// Compare a view to a string
+/// < v View
+/// < s String
+/// > True if equal
+static bool view_is(VIEW v, const char* s)
+{
+    return (int)strlen(s) == v.len && strncmp(v.p,s,v.len) == 0;
+}
+
+/// Get an integer attribute
+/// < t Tag
+/// < key Attribute name
+/// < def Default value
+/// > Value
+static int tag_int(TAG* t, const char* key, int def)
+{
+    int i = 0;
+    for(; i < t->count; i++)
+    {
+        if(view_is(t->keys[i],key))
+            return atoi(t->values[i].p);
+    }
+    return def;
+}
+
+/// Get a string attribute
+/// < t Tag
+/// < key Attribute name
+/// > Value, empty if not set
+static VIEW tag_str(TAG* t, const char* key)
+{
+    int i = 0;
+    for(; i < t->count; i++)
+    {
+        if(view_is(t->keys[i],key))
+            return t->values[i];
+    }
+    return (VIEW){"",0};
+}
+
+/// Read the next tag, skips text, comments and declarations
+/// < p Read position, moved past the tag
+/// < end End of data
+/// < t Tag to fill
+/// > True if a tag was read
+static bool next_tag(const char** p, const char* end, TAG* t)
+{
+    const char* s = *p;
+    for(;;)
+    {
+        while(s < end && *s != '<') s++;
+        if(s+1 >= end) return false;
+        s ++;
+
+        // Comment, declaration or processing instruction
+        if(*s == '!' || *s == '?')
+        {
+            if(end-s > 3 && strncmp(s,"!--",3) == 0)
+            {
+                for(s += 3; s+2 < end && strncmp(s,"-->",3) != 0; s++);
+            }
+            continue;
+        }
+        break;
+    }
+
+    t->closing = *s == '/';
+    if(t->closing) s ++;
+
+    // Name
+    t->name.p = s;
+    while(s < end && *s != ' ' && *s != '>' && *s != '/' && *s != '\n' && *s != '\t' && *s != '\r') s++;
+    t->name.len = (int)(s - t->name.p);
+
+    // Attributes
+    t->count = 0;
+    t->empty = false;
+    while(s < end && *s != '>')
+    {
+        if(*s == '/')
+        {
+            t->empty = true;
+            s ++;
+            continue;
+        }
+        if(*s == ' ' || *s == '\n' || *s == '\t' || *s == '\r')
+        {
+            s ++;
+            continue;
+        }
+
+        VIEW key = {s,0};
+        while(s < end && *s != '=' && *s != '>' && *s != ' ') s++;
+        key.len = (int)(s - key.p);
+        if(s >= end || *s != '=') continue;
+        s ++;
+
+        char quote = s < end ? *s : 0;
+        if(quote != '"' && quote != '\'') continue;
+        s ++;
+        VIEW value = {s,0};
+        while(s < end && *s != quote) s++;
+        value.len = (int)(s - value.p);
+        if(s < end) s ++;
+
+        if(t->count < MAX_ATTRIBS)
+        {
+            t->keys[t->count] = key;
+            t->values[t->count] = value;
+            t->count ++;
+        }
+    }
+    if(s < end) s ++;
+
+    *p = s;
+    return true;
+}
+
+/// Push decoded layer bytes, four bytes make a gid
+/// < g Gid state
+/// < bytes Bytes
+/// < len Byte count
+static void push_bytes(GID_STATE* g, const Uint8* bytes, int len)
+{
+    int i = 0;
+    for(; i < len; i++)
+    {
+        g->acc |= (Uint32)bytes[i] << g->shift;
+        g->shift += 8;
+        if(g->shift == 32)
+        {
+            // Drop flip flags, ids that do not fit are left empty
+            Uint32 gid = g->acc & 0x1FFFFFFF;
+            if(g->index < g->count)
+                g->out[g->index] = gid <= 0xFFFF ? (Uint16)gid : 0;
+            g->index ++;
+            g->acc = 0;
+            g->shift = 0;
+        }
+    }
+}
+
+/// Decode base64 (and possibly zlib/gzip) layer data
+/// < s Text start
+/// < end Text end
+/// < compressed Is the data compressed
+/// < g Gid state
+/// > 0 on success, 1 on error
+static int decode_layer(const char* s, const char* end, bool compressed, GID_STATE* g)
+{
+    Uint8 in[DECODE_CHUNK];
+    Uint8 out[DECODE_CHUNK*4];
+    z_stream zs;
+    int ret = Z_OK;
+
+    if(compressed)
+    {
+        memset(&zs,0,sizeof(z_stream));
+        // Detect zlib or gzip header
+        if(inflateInit2(&zs,15+32) != Z_OK)
+            return 1;
+    }
+
+    Uint32 acc = 0;
+    int bits = 0;
+    int len;
+    while(s < end && ret != Z_STREAM_END)
+    {
+        // Decode a chunk of base64
+        len = 0;
+        for(; s < end && len < DECODE_CHUNK; s++)
+        {
+            if(!is_b64(*s)) continue;
+
+            acc = (acc << 6) | b64[(Uint8)*s];
+            bits += 6;
+            if(bits >= 8)
+            {
+                bits -= 8;
+                in[len ++] = (Uint8)(acc >> bits);
+            }
+        }
+
+        if(!compressed)
+        {
+            push_bytes(g,in,len);
+            continue;
+        }
+
+        // Feed it to the inflater
+        zs.next_in = in;
+        zs.avail_in = len;
+        do
+        {
+            zs.next_out = out;
+            zs.avail_out = sizeof(out);
+            ret = inflate(&zs,Z_NO_FLUSH);
+            if(ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+            {
+                inflateEnd(&zs);
+                return 1;
+            }
+            push_bytes(g,out,sizeof(out) - zs.avail_out);
+        }
+        while(zs.avail_out == 0 && ret != Z_STREAM_END);
+    }
+
+    if(compressed)
+    {
+        inflateEnd(&zs);
+        if(ret != Z_STREAM_END) return 1;
+    }
+
+    return g->index == g->count ? 0 : 1;
+}
+
+/// Read a whole file to memory
+/// < path File path
+/// < len File length
+/// > File data, NULL on error
+static char* read_file(const char* path, long* len)
+{
+    FILE* f = fopen(path,"rb");
+    if(f == NULL)
+    {
+        return NULL;
+    }
+
+    fseek(f,0,SEEK_END);
+    *len = ftell(f);
+    fseek(f,0,SEEK_SET);
+
+    char* data = *len >= 0 ? (char*)malloc(*len +1) : NULL;
+    if(data == NULL || fread(data,1,*len,f) != (size_t)*len)
+    {
+        free(data);
+        fclose(f);
+        return NULL;
+    }
+    data[*len] = '\0';
+    fclose(f);
+
+    return data;
+}
+
+/// Parse a TMX document
+/// < t Tilemap to fill
+/// < s Document start
+/// < end Document end
+/// < err Error message buffer
+/// < errLen Error message buffer size
+/// > 0 on success, 1 on error
+static int parse_tmx(TILEMAP* t, const char* s, const char* end, char* err, int errLen)
+{
+    TAG tag;
+    bool compressed = false;
+    bool base64 = false;
+
+    t->layerCount = 0;
+    while(next_tag(&s,end,&tag))
+    {
+        if(tag.closing) continue;
+
+        if(view_is(tag.name,"map"))
+        {
+            t->w = tag_int(&tag,"width",0);
+            t->h = tag_int(&tag,"height",0);
+            t->tileW = tag_int(&tag,"tilewidth",0);
+            t->tileH = tag_int(&tag,"tileheight",0);
+            if(t->w <= 0 || t->h <= 0 || t->w > 4096 || t->h > 4096)
+            {
+                snprintf(err,errLen,"Invalid map size");
+                return 1;
+            }
+        }
+        else if(view_is(tag.name,"tileset"))
+        {
+            if(t->firstGid == 0)
+                t->firstGid = tag_int(&tag,"firstgid",1);
+        }
+        else if(view_is(tag.name,"layer"))
+        {
+            if(t->w <= 0 || t->layerCount >= MAX_LAYERS)
+            {
+                snprintf(err,errLen,"Unexpected layer");
+                return 1;
+            }
+        }
+        else if(view_is(tag.name,"data") && !tag.empty)
+        {
+            base64 = view_is(tag_str(&tag,"encoding"),"base64");
+            VIEW comp = tag_str(&tag,"compression");
+            compressed = view_is(comp,"zlib") || view_is(comp,"gzip");
+            if(!base64 || (!compressed && comp.len > 0) || t->w <= 0)
+            {
+                snprintf(err,errLen,"Unsupported layer data");
+                return 1;
+            }
+
+            // Layers are stored one after another
+            const char* dataEnd = s;
+            while(dataEnd < end && *dataEnd != '<') dataEnd++;
+
+            Uint16* tiles = (Uint16*)realloc(t->tiles,sizeof(Uint16) * t->w * t->h * (t->layerCount+1));
+            if(tiles == NULL)
+            {
+                snprintf(err,errLen,"Memory allocation error");
+                return 1;
+            }
+            t->tiles = tiles;
+
+            GID_STATE g = {tiles + t->w * t->h * t->layerCount, t->w * t->h, 0, 0, 0};
+            if(decode_layer(s,dataEnd,compressed,&g) != 0)
+            {
+                snprintf(err,errLen,"Invalid layer data");
+                return 1;
+            }
+            t->layerCount ++;
+            s = dataEnd;
+        }
+    }
+
+    if(t->layerCount == 0)
+    {
+        snprintf(err,errLen,"No layers");
+        return 1;
+    }
+
+    return 0;
+}
+
+/// Decode a TMX tilemap without reporting errors
+TILEMAP* decode_tilemap(const char* path, char* err, int errLen)
+{
+    long len;
+    char* data = read_file(path,&len);
+    if(data == NULL)
+    {
+        snprintf(err,errLen,"Failed to load a tilemap in %s!",path);
+        return NULL;
+    }
+
+    TILEMAP* t = (TILEMAP*)malloc(sizeof(TILEMAP));
+    if(t == NULL)
+    {
+        snprintf(err,errLen,"Failed to allocate memory for a tilemap!");
+        free(data);
+        return NULL;
+    }
+    memset(t,0,sizeof(TILEMAP));
+
+    char msg[64];
+    if(parse_tmx(t,data,data+len,msg,64) != 0)
+    {
+        snprintf(err,errLen,"Failed to parse a tilemap in %s: %s!",path,msg);
+        destroy_tilemap(t);
+        free(data);
+        return NULL;
+    }
+    if(t->firstGid == 0) t->firstGid = 1;
+
+    free(data);
+    return t;
+}
+
+/// Load a TMX tilemap
+TILEMAP* load_tilemap(const char* path)
+{
+    char err[128];
+    TILEMAP* t = decode_tilemap(path,err,128);
+    if(t == NULL)
+    {
+        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!",err,NULL);
+    }
+
+    return t;
+}
+
+/// Get a tile id
+Uint16 tmap_get_tile(TILEMAP* t, int layer, int x, int y)
+{
+    if(layer < 0 || layer >= t->layerCount || x < 0 || y < 0 || x >= t->w || y >= t->h)
+        return 0;
+
+    return t->tiles[(layer * t->h + y) * t->w + x];
+}
+
+/// Destroy a tilemap
+void destroy_tilemap(TILEMAP* t)
+{
+    if(t == NULL) return;
+
+    free(t->tiles);
+    free(t);
+}
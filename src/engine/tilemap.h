@@ -0,0 +1,46 @@
+/// Tilemap (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __TILEMAP__
+#define __TILEMAP__
+
+#include "SDL2/SDL.h"
+
+/// Tilemap type
+typedef struct
+{
+    int w; /// Width in tiles
+    int h; /// Height in tiles
+    int tileW; /// Tile width in pixels
+    int tileH; /// Tile height in pixels
+    int firstGid; /// First tile id of the tileset
+    int layerCount; /// Amount of layers
+    Uint16* tiles; /// Tile ids, layer by layer (0 is empty)
+}
+TILEMAP;
+
+/// Decode a TMX tilemap without reporting errors
+/// < path File path
+/// < err Error message buffer
+/// < errLen Error message buffer size
+/// > A new tilemap, NULL on error
+TILEMAP* decode_tilemap(const char* path, char* err, int errLen);
+
+/// Load a TMX tilemap
+/// < path File path
+/// > A new tilemap, NULL on error
+TILEMAP* load_tilemap(const char* path);
+
+/// Get a tile id
+/// < t Tilemap
+/// < layer Layer index
+/// < x X coordinate in tiles
+/// < y Y coordinate in tiles
+/// > Tile id, 0 if empty or out of range
+Uint16 tmap_get_tile(TILEMAP* t, int layer, int x, int y);
+
+/// Destroy a tilemap
+/// < t Tilemap to destroy
+void destroy_tilemap(TILEMAP* t);
+
+#endif // __TILEMAP__
@@ -0,0 +1,208 @@
+/// Tilemap renderer (source)
+/// (c) 2017 Jani Nykänen
+
+#include "tmaprender.h"
+
+#include "graphics.h"
+#include "assets.h"
+
+#include "stdlib.h"
+#include "string.h"
+
+/// Render a chunk to its cache
+/// < r Renderer
+/// < b Tileset bitmap
+/// < c Chunk
+/// < cx Chunk x
+/// < cy Chunk y
+/// > 0 on success, 1 on error
+static int render_chunk(TMAP_RENDERER* r, BITMAP* b, TMAP_CHUNK* c, int cx, int cy)
+{
+    c->data = (Uint8*)malloc(CHUNK_WIDTH * CHUNK_HEIGHT);
+    if(c->data == NULL)
+    {
+        return 1;
+    }
+    memset(c->data,255,CHUNK_WIDTH * CHUNK_HEIGHT);
+
+    TILEMAP* t = r->map;
+    int columns = b->w / t->tileW;
+    int tileCount = columns * (b->h / t->tileH);
+
+    int x,y,row;
+    int id;
+    Uint8* dst;
+    const Uint8* src;
+    for(y=0; y < r->ch; y++)
+    {
+        for(x=0; x < r->cw; x++)
+        {
+            id = tmap_get_tile(t,r->layer,cx*r->cw +x,cy*r->ch +y) - t->firstGid;
+            if(id < 0 || id >= tileCount) continue;
+
+            src = b->data + (id/columns)*t->tileH*b->pitch + (id%columns)*t->tileW;
+            dst = c->data + y*t->tileH*CHUNK_WIDTH + x*t->tileW;
+            for(row=0; row < t->tileH; row++)
+            {
+                memcpy(dst + row*CHUNK_WIDTH,src + row*b->pitch,t->tileW);
+            }
+        }
+    }
+
+    // Opaque chunks are drawn with plain copies
+    c->opaque = memchr(c->data,255,CHUNK_WIDTH * CHUNK_HEIGHT) == NULL;
+
+    return 0;
+}
+
+/// Create a renderer for a tilemap layer
+TMAP_RENDERER* create_tmap_renderer(TILEMAP* map, int tileset, int layer)
+{
+    if(map->tileW <= 0 || map->tileH <= 0
+        || map->tileW > CHUNK_WIDTH || map->tileH > CHUNK_HEIGHT)
+    {
+        return NULL;
+    }
+
+    TMAP_RENDERER* r = (TMAP_RENDERER*)malloc(sizeof(TMAP_RENDERER));
+    if(r == NULL)
+    {
+        return NULL;
+    }
+
+    r->map = map;
+    r->tileset = tileset;
+    r->version = get_asset_version(tileset);
+    r->layer = layer;
+    r->cw = CHUNK_WIDTH / map->tileW;
+    r->ch = CHUNK_HEIGHT / map->tileH;
+    r->chunksX = (map->w + r->cw-1) / r->cw;
+    r->chunksY = (map->h + r->ch-1) / r->ch;
+
+    r->chunks = (TMAP_CHUNK*)calloc(r->chunksX * r->chunksY,sizeof(TMAP_CHUNK));
+    if(r->chunks == NULL)
+    {
+        free(r);
+        return NULL;
+    }
+
+    return r;
+}
+
+/// Change a tile
+void tmr_set_tile(TMAP_RENDERER* r, int x, int y, Uint16 id)
+{
+    TILEMAP* t = r->map;
+    if(x < 0 || y < 0 || x >= t->w || y >= t->h)
+        return;
+
+    Uint16* tile = &t->tiles[(r->layer * t->h + y) * t->w + x];
+    if(*tile == id) return;
+    *tile = id;
+
+    // Rendered again when next visible
+    TMAP_CHUNK* c = &r->chunks[(y / r->ch) * r->chunksX + x / r->cw];
+    free(c->data);
+    c->data = NULL;
+}
+
+/// Invalidate all chunks
+void tmr_invalidate(TMAP_RENDERER* r)
+{
+    int i = 0;
+    for(; i < r->chunksX * r->chunksY; i++)
+    {
+        free(r->chunks[i].data);
+        r->chunks[i].data = NULL;
+    }
+}
+
+/// Draw the layer
+void draw_tilemap(TMAP_RENDERER* r, int dx, int dy)
+{
+    BITMAP* b = get_bitmap_handle(r->tileset);
+    if(b == NULL) return;
+
+    // The chunks are copies of the old pixels
+    int version = get_asset_version(r->tileset);
+    if(version != r->version)
+    {
+        tmr_invalidate(r);
+        r->version = version;
+    }
+
+    RENDER_CTX* ctx = get_render_ctx();
+    FRAME* fr = ctx->frame;
+    dx += ctx->transX;
+    dy += ctx->transY;
+
+    // Chunk area in pixels
+    int pw = r->cw * r->map->tileW;
+    int ph = r->ch * r->map->tileH;
+
+    // Visible chunks
+    int cx0 = dx < 0 ? -dx / pw : 0;
+    int cy0 = dy < 0 ? -dy / ph : 0;
+    int cx1 = (fr->w - dx + pw-1) / pw;
+    int cy1 = (fr->h - dy + ph-1) / ph;
+    if(cx1 > r->chunksX) cx1 = r->chunksX;
+    if(cy1 > r->chunksY) cy1 = r->chunksY;
+
+    int cx,cy;
+    int x0,y0,x1,y1;
+    int y,x;
+    TMAP_CHUNK* c;
+    const Uint8* src;
+    Uint8* dst;
+    for(cy=cy0; cy < cy1; cy++)
+    {
+        for(cx=cx0; cx < cx1; cx++)
+        {
+            c = &r->chunks[cy*r->chunksX +cx];
+            if(c->data == NULL && render_chunk(r,b,c,cx,cy) != 0)
+                continue;
+
+            // Clip to the frame
+            x0 = dx + cx*pw;
+            y0 = dy + cy*ph;
+            x1 = x0 + pw;
+            y1 = y0 + ph;
+            int sx = x0 < 0 ? -x0 : 0;
+            int sy = y0 < 0 ? -y0 : 0;
+            if(x0 < 0) x0 = 0;
+            if(y0 < 0) y0 = 0;
+            if(x1 > fr->w) x1 = fr->w;
+            if(y1 > fr->h) y1 = fr->h;
+            if(x1 <= x0 || y1 <= y0) continue;
+
+            src = c->data + sy*CHUNK_WIDTH + sx;
+            dst = fr->colorData + y0*fr->pitch + x0;
+            for(y=y0; y < y1; y++)
+            {
+                if(c->opaque)
+                {
+                    memcpy(dst,src,x1-x0);
+                }
+                else
+                {
+                    for(x=0; x < x1-x0; x++)
+                    {
+                        if(src[x] != 255) dst[x] = src[x];
+                    }
+                }
+                src += CHUNK_WIDTH;
+                dst += fr->pitch;
+            }
+        }
+    }
+}
+
+/// Destroy a renderer
+void destroy_tmap_renderer(TMAP_RENDERER* r)
+{
+    if(r == NULL) return;
+
+    tmr_invalidate(r);
+    free(r->chunks);
+    free(r);
+}
@@ -0,0 +1,70 @@
+/// Tilemap renderer (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __TMAP_RENDER__
+#define __TMAP_RENDER__
+
+#include "tilemap.h"
+
+#include "stdbool.h"
+
+/// Chunk width in pixels
+#define CHUNK_WIDTH 128
+/// Chunk height in pixels
+#define CHUNK_HEIGHT 128
+
+/// Pre-rendered chunk
+typedef struct
+{
+    Uint8* data; /// Indexed pixels, NULL if not rendered
+    bool opaque; /// Has no transparent pixels
+}
+TMAP_CHUNK;
+
+/// Tilemap layer renderer
+typedef struct
+{
+    TILEMAP* map; /// Tilemap
+    int tileset; /// Tileset bitmap handle
+    int version; /// Tileset version the chunks were rendered from
+    int layer; /// Layer index
+    int cw; /// Chunk width in tiles
+    int ch; /// Chunk height in tiles
+    int chunksX; /// Chunks horizontally
+    int chunksY; /// Chunks vertically
+    TMAP_CHUNK* chunks; /// Chunk cache
+}
+TMAP_RENDERER;
+
+/// Create a renderer for a tilemap layer. The tileset is
+/// looked up by handle, so reloaded pixels are picked up
+/// < map Tilemap
+/// < tileset Tileset bitmap handle
+/// < layer Layer index
+/// > A new renderer, NULL on error
+TMAP_RENDERER* create_tmap_renderer(TILEMAP* map, int tileset, int layer);
+
+/// Change a tile and invalidate its chunk
+/// < r Renderer
+/// < x X coordinate in tiles
+/// < y Y coordinate in tiles
+/// < id New tile id
+void tmr_set_tile(TMAP_RENDERER* r, int x, int y, Uint16 id);
+
+/// Invalidate all chunks, for example when the tileset changes
+/// < r Renderer
+void tmr_invalidate(TMAP_RENDERER* r);
+
+/// Draw the layer to the current frame. Visible chunks are
+/// rendered on first use and then copied row by row. All the
+/// chunks are rendered again when the tileset changes
+/// < r Renderer
+/// < dx Map left edge in the frame
+/// < dy Map top edge in the frame
+void draw_tilemap(TMAP_RENDERER* r, int dx, int dy);
+
+/// Destroy a renderer
+/// < r Renderer to destroy
+void destroy_tmap_renderer(TMAP_RENDERER* r);
+
+#endif // __TMAP_RENDER__
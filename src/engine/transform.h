@@ -6,6 +6,37 @@
 
 #include "vector.h"
 
+#include "stdbool.h"
+
+/// Transformation state. Each thread uses the one it has
+/// bound, or a shared default one
+typedef struct
+{
+    VEC3 tr; /// World translation
+    VEC3 modelTr; /// Model translation
+    float worldAngle1; /// World angle ("horizontal")
+    float worldAngle2; /// World angle ("vertical")
+    bool worldChanged; /// Is the world angle changed
+    float modelAngle1; /// Model angle ("horizontal")
+    float modelAngle2; /// Model angle ("vertical")
+    float modelAngle3; /// Model angle ("the third one")
+    bool modelChanged; /// Is the model angle changed
+    float wsc[4]; /// World sine cosine
+    float msc[6]; /// Model sine cosine
+    VEC3 modelScale; /// Model scale
+    float FOVvalue; /// FOV value
+}
+TRANSFORM;
+
+/// Initialize a transformation
+/// < tf Transformation
+void tr_init(TRANSFORM* tf);
+
+/// Bind a transformation to the calling thread. The
+/// functions below use the bound transformation
+/// < tf Transformation, NULL for the default one
+void tr_bind(TRANSFORM* tf);
+
 /// Identity
 void tr_identity();
 
@@ -0,0 +1,156 @@
+/// Transition effects (source)
+/// (c) 2017 Jani Nykänen
+
+#include "transition.h"
+
+#include "graphics.h"
+
+#include "stdlib.h"
+#include "stdbool.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/// Dissolve masks, one bit per pixel in an 8x8 cell
+static Uint8 masks[DISSOLVE_PATTERN_COUNT][DISSOLVE_LEVELS+1][8];
+/// Are the masks generated
+static bool masksReady = false;
+
+/// Get a 8x8 Bayer matrix value
+/// < x X coordinate
+/// < y Y coordinate
+/// > Value, 0-63
+static int bayer(int x, int y)
+{
+    int v = 0;
+    int k = 0;
+    for(; k < 3; k++)
+    {
+        v = (v << 2) | (((x^y) >> k) & 1) << 1 | ((y >> k) & 1);
+    }
+    return v;
+}
+
+/// Get the ordering key of a pixel in a pattern
+/// < pattern Pattern
+/// < x X coordinate
+/// < y Y coordinate
+/// > Key, smaller keys are drawn first
+static int pattern_key(int pattern, int x, int y)
+{
+    static const int order[8] = {0,4,2,6,1,5,3,7};
+
+    switch(pattern)
+    {
+    case DISSOLVE_STRIPES:
+        return order[y]*8 + order[x];
+
+    case DISSOLVE_CHECKER:
+        return (((x >> 2) ^ (y >> 2)) & 1) * 64 + bayer(x,y);
+
+    default:
+        return bayer(x,y);
+    }
+}
+
+/// Generate dissolve masks
+void init_transitions()
+{
+    int keys[64];
+    int p,i,j,rank,level;
+    for(p=0; p < DISSOLVE_PATTERN_COUNT; p++)
+    {
+        for(i=0; i < 64; i++)
+        {
+            keys[i] = pattern_key(p,i % 8,i / 8);
+        }
+
+        // A pixel is drawn on levels above its rank
+        for(i=0; i < 64; i++)
+        {
+            rank = 0;
+            for(j=0; j < 64; j++)
+            {
+                if(keys[j] < keys[i]) rank ++;
+            }
+
+            for(level=rank+1; level <= DISSOLVE_LEVELS; level++)
+            {
+                masks[p][level][i / 8] |= 1 << (i % 8);
+            }
+        }
+    }
+    masksReady = true;
+}
+
+/// Draw a bitmap region through a dissolve mask
+void draw_dissolve(BITMAP* b, int sx, int sy, int sw, int sh, int dx, int dy, int pattern, float progress)
+{
+    if(b == NULL) return;
+
+    if(!masksReady) init_transitions();
+    if(pattern < 0 || pattern >= DISSOLVE_PATTERN_COUNT) pattern = DISSOLVE_BAYER;
+
+    int level = (int)(progress * DISSOLVE_LEVELS + 0.5f);
+    if(level <= 0) return;
+    if(level > DISSOLVE_LEVELS) level = DISSOLVE_LEVELS;
+
+    FRAME* fr = get_current_frame();
+    SDL_Point tr = get_translation();
+    dx += tr.x;
+    dy += tr.y;
+
+    // Clip to the frame
+    if(dx < 0) { sx -= dx; sw += dx; dx = 0; }
+    if(dy < 0) { sy -= dy; sh += dy; dy = 0; }
+    if(dx + sw > fr->w) sw = fr->w - dx;
+    if(dy + sh > fr->h) sh = fr->h - dy;
+    if(sw <= 0 || sh <= 0) return;
+
+    const Uint8* cell = masks[pattern][level];
+    const Uint8* src;
+    Uint8* dst;
+    int x,y;
+    int shift = dx & 7;
+    Uint8 bits;
+
+#ifdef __SSE2__
+    const __m128i sel = _mm_set_epi8(
+        (char)128,64,32,16,8,4,2,1,(char)128,64,32,16,8,4,2,1);
+    const __m128i key = _mm_set1_epi8((char)255);
+    __m128i m, s, d, w;
+#endif
+
+    for(y=0; y < sh; y++)
+    {
+        src = b->data + (sy+y)*b->pitch + sx;
+        dst = fr->colorData + (dy+y)*fr->pitch + dx;
+
+        // Rotate the mask row so that bit 0 is the first pixel
+        bits = cell[(dy+y) & 7];
+        bits = (Uint8)((bits >> shift) | (bits << ((8-shift) & 7)));
+        if(bits == 0) continue;
+
+        x = 0;
+
+#ifdef __SSE2__
+        // Expand the bits to a byte mask, leave out the color key
+        m = _mm_cmpeq_epi8(_mm_and_si128(_mm_set1_epi8((char)bits),sel),sel);
+        for(; x+16 <= sw; x += 16)
+        {
+            s = _mm_loadu_si128((const __m128i*)(src + x));
+            d = _mm_loadu_si128((const __m128i*)(dst + x));
+            w = _mm_andnot_si128(_mm_cmpeq_epi8(s,key),m);
+            _mm_storeu_si128((__m128i*)(dst + x),
+                _mm_or_si128(_mm_and_si128(w,s),_mm_andnot_si128(w,d)));
+        }
+#endif
+
+        for(; x < sw; x++)
+        {
+            if( (bits >> (x & 7)) & 1 && src[x] != 255)
+                dst[x] = src[x];
+        }
+    }
+}
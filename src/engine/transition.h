@@ -0,0 +1,38 @@
+/// Transition effects (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __TRANSITION__
+#define __TRANSITION__
+
+#include "bitmap.h"
+
+/// Dissolve patterns
+enum
+{
+    DISSOLVE_BAYER = 0,
+    DISSOLVE_STRIPES = 1,
+    DISSOLVE_CHECKER = 2,
+    DISSOLVE_PATTERN_COUNT = 3,
+};
+
+/// Amount of dissolve levels above zero
+#define DISSOLVE_LEVELS 64
+
+/// Generate dissolve masks
+void init_transitions();
+
+/// Draw a bitmap region through a dissolve mask. The mask is
+/// fixed to the frame, so the same pixels stay drawn
+/// as the progress grows
+/// < b Bitmap to be drawn
+/// < sx Source X
+/// < sy Source Y
+/// < sw Source W
+/// < sh Source H
+/// < dx X coordinate
+/// < dy Y coordinate
+/// < pattern Dissolve pattern
+/// < progress Drawn share, 0 draws nothing and 1 everything
+void draw_dissolve(BITMAP* b, int sx, int sy, int sw, int sh, int dx, int dy, int pattern, float progress);
+
+#endif // __TRANSITION__
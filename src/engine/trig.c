@@ -0,0 +1,140 @@
+/// Fast trigonometry (source)
+/// (c) 2017 Jani Nykänen
+
+#include "trig.h"
+
+#include "math.h"
+#include "stdbool.h"
+
+/// Radians to angle units
+#define RAD_TO_ANGLE (ANGLE_TURN / (2.0 * M_PI))
+/// Angle units per radian, 32 fractional bits
+#define ANGLE_PER_RAD 683565276LL
+/// Angle bits below the table index
+#define FRAC_BITS 4
+/// Table entries per quarter turn
+#define QUARTER (TRIG_TABLE_SIZE / 4)
+/// Quarter turn in radians, 30 fractional bits
+#define HALF_PI_Q30 1686629713LL
+/// Taylor series terms after the first
+#define SERIES_TERMS 7
+
+/// Sine table, with the first entry repeated at the end
+static FIXED sinTable[TRIG_TABLE_SIZE +1];
+/// Is the table generated
+static bool tableReady = false;
+
+/// Sine of a table step in the first quadrant, from the Taylor
+/// series in 30-bit fixed point
+/// < j Step, 0 to QUARTER
+/// > Sine
+static FIXED quarter_sin(int j)
+{
+    Sint64 x = HALF_PI_Q30 * j / QUARTER;
+    Sint64 x2 = (x*x) >> 30;
+    Sint64 term = x;
+    Sint64 sum = x;
+    int k = 1;
+    for(; k <= SERIES_TERMS; k++)
+    {
+        term = -((term * x2) >> 30) / ((2*k) * (2*k+1));
+        sum += term;
+    }
+
+    return (FIXED)((sum + (1 << 13)) >> 14);
+}
+
+/// Look up the table, which must be generated
+/// < a Angle
+/// > Sine
+static FIXED lookup(ANGLE a)
+{
+    int i = a >> FRAC_BITS;
+    int t = a & ((1 << FRAC_BITS) -1);
+
+    return sinTable[i] + (((sinTable[i+1] - sinTable[i]) * t) >> FRAC_BITS);
+}
+
+/// Generate the sine table
+void init_trig()
+{
+    int i = 0;
+    int j;
+    for(; i <= TRIG_TABLE_SIZE; i++)
+    {
+        j = i % QUARTER;
+        switch((i / QUARTER) & 3)
+        {
+        case 0:
+            sinTable[i] = quarter_sin(j);
+            break;
+        case 1:
+            sinTable[i] = quarter_sin(QUARTER - j);
+            break;
+        case 2:
+            sinTable[i] = -quarter_sin(j);
+            break;
+        default:
+            sinTable[i] = -quarter_sin(QUARTER - j);
+            break;
+        }
+    }
+    tableReady = true;
+}
+
+/// Convert radians to a fixed-point angle
+ANGLE rad_to_angle(float rad)
+{
+    // Through 64 bits, so that large angles wrap instead of overflowing
+    return (ANGLE)(Sint64)(rad * RAD_TO_ANGLE);
+}
+
+/// Convert fixed-point radians to a fixed-point angle
+ANGLE fx_to_angle(FIXED rad)
+{
+    return (ANGLE)(Uint64)(((Sint64)rad * ANGLE_PER_RAD) >> 32);
+}
+
+/// Fixed-point sine of a fixed-point angle
+FIXED fx_sin_angle(ANGLE a)
+{
+    if(!tableReady) init_trig();
+
+    return lookup(a);
+}
+
+/// Fixed-point sines of an array of angles in radians
+void fx_sin_batch(const FIXED* rad, FIXED* out, int n)
+{
+    if(!tableReady) init_trig();
+
+    int i = 0;
+    for(; i < n; i++)
+    {
+        out[i] = lookup(fx_to_angle(rad[i]));
+    }
+}
+
+/// Sine of a fixed-point angle
+float sin_angle(ANGLE a)
+{
+    return (float)fx_sin_angle(a) * (1.0f / FIXED_ONE);
+}
+
+/// Cosine of a fixed-point angle
+float cos_angle(ANGLE a)
+{
+    return sin_angle((ANGLE)(a + ANGLE_TURN/4));
+}
+
+/// Fast sine
+float fast_sin(float rad)
+{
+    return sin_angle(rad_to_angle(rad));
+}
+
+/// Fast cosine
+float fast_cos(float rad)
+{
+    return cos_angle(rad_to_angle(rad));
+}
@@ -0,0 +1,65 @@
+/// Fast trigonometry (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __TRIG__
+#define __TRIG__
+
+#include "SDL2/SDL.h"
+
+#include "fixed.h"
+
+/// Fixed-point angle, a full turn is 65536 and wraps around
+typedef Uint16 ANGLE;
+
+/// Angle units per full turn
+#define ANGLE_TURN 65536
+/// Sine table size
+#define TRIG_TABLE_SIZE 4096
+
+/// Generate the sine table. The table is built with integer
+/// operations only, so it is the same on every machine.
+/// Call before starting threads that use it
+void init_trig();
+
+/// Convert radians to a fixed-point angle
+/// < rad Angle in radians
+/// > Fixed-point angle
+ANGLE rad_to_angle(float rad);
+
+/// Convert fixed-point radians to a fixed-point angle
+/// < rad Angle in radians
+/// > Fixed-point angle
+ANGLE fx_to_angle(FIXED rad);
+
+/// Fixed-point sine of a fixed-point angle
+/// < a Angle
+/// > Sine
+FIXED fx_sin_angle(ANGLE a);
+
+/// Fixed-point sines of an array of angles in radians
+/// < rad Angles in radians
+/// < out Sines, may be the same array as rad
+/// < n Amount of angles
+void fx_sin_batch(const FIXED* rad, FIXED* out, int n);
+
+/// Sine of a fixed-point angle
+/// < a Angle
+/// > Sine
+float sin_angle(ANGLE a);
+
+/// Cosine of a fixed-point angle
+/// < a Angle
+/// > Cosine
+float cos_angle(ANGLE a);
+
+/// Fast sine
+/// < rad Angle in radians
+/// > Sine
+float fast_sin(float rad);
+
+/// Fast cosine
+/// < rad Angle in radians
+/// > Cosine
+float fast_cos(float rad);
+
+#endif // __TRIG__
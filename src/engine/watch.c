@@ -0,0 +1,154 @@
+/// File watcher (source)
+/// (c) 2017 Jani Nykänen
+
+#include "watch.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/inotify.h>
+
+/// Maximum amount of watched directories
+#define MAX_DIRS 64
+
+/// Watched directory
+typedef struct
+{
+    int wd; /// Watch descriptor
+    char path[256]; /// Directory path
+}
+WATCH_DIR;
+
+/// Inotify instance
+static int fd = -1;
+/// Watched directories
+static WATCH_DIR dirs[MAX_DIRS];
+/// Directory count
+static int dirCount;
+
+/// Initialize the file watcher
+int watch_init()
+{
+    if(fd >= 0) return 0;
+
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd < 0)
+    {
+        printf("Failed to initialize the file watcher!\n");
+        return 1;
+    }
+    dirCount = 0;
+
+    return 0;
+}
+
+/// Watch a file for changes
+int watch_file(const char* path)
+{
+    if(fd < 0) return 1;
+
+    // Watch the directory, since editors tend to
+    // replace files instead of writing to them
+    char dir[256];
+    const char* slash = strrchr(path,'/');
+    if(slash == NULL)
+        strcpy(dir,".");
+    else
+        snprintf(dir,256,"%.*s",(int)(slash-path),path);
+
+    int i = 0;
+    for(; i < dirCount; i++)
+    {
+        if(strcmp(dirs[i].path,dir) == 0)
+            return 0;
+    }
+    if(dirCount >= MAX_DIRS)
+    {
+        return 1;
+    }
+
+    int wd = inotify_add_watch(fd,dir,IN_CLOSE_WRITE | IN_MOVED_TO);
+    if(wd < 0)
+    {
+        printf("Failed to watch %s!\n",dir);
+        return 1;
+    }
+    dirs[dirCount].wd = wd;
+    strcpy(dirs[dirCount].path,dir);
+    dirCount ++;
+
+    return 0;
+}
+
+/// Poll changed files
+void watch_poll(void (*cb) (const char*))
+{
+    if(fd < 0) return;
+
+    char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    char path[512];
+    ssize_t len;
+    char* p;
+    struct inotify_event* ev;
+    int i;
+
+    while( (len = read(fd,buffer,sizeof(buffer))) > 0)
+    {
+        for(p = buffer; p < buffer + len; p += sizeof(struct inotify_event) + ev->len)
+        {
+            ev = (struct inotify_event*)p;
+            if(ev->len == 0) continue;
+
+            for(i=0; i < dirCount; i++)
+            {
+                if(dirs[i].wd != ev->wd) continue;
+
+                if(strcmp(dirs[i].path,".") == 0)
+                    snprintf(path,512,"%s",ev->name);
+                else
+                    snprintf(path,512,"%s/%s",dirs[i].path,ev->name);
+                cb(path);
+                break;
+            }
+        }
+    }
+}
+
+/// Stop watching
+void watch_close()
+{
+    if(fd < 0) return;
+
+    close(fd);
+    fd = -1;
+    dirCount = 0;
+}
+
+#else
+
+/// Initialize the file watcher (not supported)
+int watch_init()
+{
+    return 1;
+}
+
+/// Watch a file for changes (not supported)
+int watch_file(const char* path)
+{
+    return 1;
+}
+
+/// Poll changed files (not supported)
+void watch_poll(void (*cb) (const char*))
+{
+}
+
+/// Stop watching (not supported)
+void watch_close()
+{
+}
+
+#endif
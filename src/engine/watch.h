@@ -0,0 +1,23 @@
+/// File watcher (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __WATCH__
+#define __WATCH__
+
+/// Initialize the file watcher
+/// > 0 on success, 1 on error (or if not supported)
+int watch_init();
+
+/// Watch a file for changes
+/// < path File path
+/// > 0 on success, 1 on error
+int watch_file(const char* path);
+
+/// Poll changed files, does not block
+/// < cb Called with the path of every changed file
+void watch_poll(void (*cb) (const char*));
+
+/// Stop watching
+void watch_close();
+
+#endif // __WATCH__
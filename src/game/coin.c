@@ -5,65 +5,107 @@
 
 #include "../engine/graphics.h"
 #include "../engine/assets.h"
+#include "../engine/trig.h"
 
 #include "player.h"
-#include "stage.h"
 
 #include "stdlib.h"
+#include "string.h"
 #include "math.h"
 
-/// Coin bitmap
-static BITMAP* bmpCoin = NULL;
+/// Coin bitmap handle
+static int hCoin = -1;
 
-/// Create a coin (that does not exist)
-COIN create_coin()
+/// Create a coin pool
+POOL* create_coin_pool(int capacity)
 {
-    if(bmpCoin == NULL) bmpCoin = get_bitmap("coin");
+    if(hCoin == -1) hCoin = get_asset_handle("coin");
 
-    COIN c;
-    c.spr = create_sprite(10,10);
-    c.exist = false;
-    return c;
+    return create_pool(capacity,sizeof(COIN));
 }
 
-/// Update coin
-void coin_update(COIN* o, PLAYER* pl, float tm)
+/// Update coins
+void update_coins(POOL* p, FIXED speed, FIXED tm)
 {
-    if(!o->exist) return;
+    int i = p->count-1;
+    int s;
+    COIN* c;
+    for(; i >= 0; i--)
+    {
+        s = p->live[i];
+        c = (COIN*)pool_cold(p,s);
 
-    spr_animate(&o->spr,0,0,3,4,tm);
+        spr_animate(&c->spr,0,0,3,fx_int(4),tm);
 
-    float speed = get_global_speed();
-    o->pos.x -= speed * tm;
-    if(o->pos.x < -10)
-        o->exist = false;
+        p->vx[s] = -speed;
+        p->x[s] += fx_mul(p->vx[s],tm);
+        if(p->x[s] < fx_int(-10))
+        {
+            pool_despawn(p,s);
+            continue;
+        }
 
-    if(pl->pos.x+2 > o->pos.x && pl->pos.x-2 < o->pos.x+10
-        && pl->pos.y-2 > o->pos.y && pl->pos.y-12 < o->pos.y+10)
-    {
-        o->exist = false;
-        pl->money ++;
+        p->phase[s] += fx_mul(fx(0.05),tm);
     }
 
-    o->waveTimer += 0.05f * tm;
-    o->pos.y = o->starty + sin(o->waveTimer) * 2;
+    // The waves of all the coins at once
+    for(i=0; i < p->count; i++)
+    {
+        p->wave[i] = p->phase[p->live[i]];
+    }
+    fx_sin_batch(p->wave,p->wave,p->count);
+    for(i=0; i < p->count; i++)
+    {
+        s = p->live[i];
+        c = (COIN*)pool_cold(p,s);
+        p->y[s] = c->starty + p->wave[i] * 2;
+    }
 }
 
-/// Draw a coin
-void coin_draw(COIN* c)
+/// Set coin boxes
+void set_coin_boxes(POOL* p, BROADPHASE* bp)
 {
-    if(!c->exist) return;
+    bp_begin(bp);
+
+    int i = 0;
+    int s;
+    for(; i < p->count; i++)
+    {
+        s = p->live[i];
+        bp_set(bp,s,fx_to_float(p->x[s]),fx_to_float(p->y[s]),10.0f,10.0f);
+    }
+
+    bp_end(bp);
+}
 
-    spr_draw(&c->spr,bmpCoin,(int)round(c->pos.x),(int)(c->pos.y),0);
+/// Draw coins
+void draw_coins(POOL* p)
+{
+    BITMAP* bmpCoin = get_bitmap_handle(hCoin);
 
-    
+    int i = 0;
+    int s;
+    for(; i < p->count; i++)
+    {
+        s = p->live[i];
+        spr_draw(&((COIN*)pool_cold(p,s))->spr,bmpCoin,fx_round(p->x[s]),fx_floor(p->y[s]),0);
+    }
 }
 
-/// Push an coin to the game world
-void push_coin(COIN* c, float x, float y)
+/// Push a coin to the game world
+int push_coin(POOL* p, RNG* r, FIXED x, FIXED y)
 {
-    c->exist = true;
-    c->pos = vec2(x,y);
+    int s = pool_spawn(p,0);
+    if(s == -1) return -1;
+
+    // Clear what the previous occupant left, the block is saved whole
+    COIN* c = (COIN*)pool_cold(p,s);
+    memset(c,0,sizeof(COIN));
+    c->spr = create_sprite(10,10);
     c->starty = y;
-    c->waveTimer = (float)(rand() % 1000)/(M_PI*2.0f);
+    p->phase[s] = rng_int(r,1000) * fx(1.0/(M_PI*2.0));
+    p->x[s] = x;
+    p->y[s] = y;
+
+    return s;
 }
@@ -6,37 +6,47 @@
 
 #include "player.h"
 
+#include "../engine/pool.h"
+#include "../engine/broadphase.h"
+#include "../engine/fixed.h"
+#include "../engine/rng.h"
+
 #include "stdbool.h"
 
-/// Coin structure
+/// Coin data, position is kept in the pool
 typedef struct
 {
-    VEC2 pos;
-    float starty;
-    float waveTimer;
+    FIXED starty;
     SPRITE spr;
-    bool exist;
 
 }COIN;
 
-/// Create a coin (that does not exist)
-/// > Coin
-COIN create_coin();
+/// Create a coin pool
+/// < capacity Maximum amount of coins
+/// > A new pool, NULL on error
+POOL* create_coin_pool(int capacity);
 
-/// Update coin
-/// < o Coin to update
-/// < pl Player object
+/// Update coins
+/// < p Coin pool
+/// < speed Global speed
 /// < tm Time mul.
-void coin_update(COIN* o, PLAYER* pl, float tm);
+void update_coins(POOL* p, FIXED speed, FIXED tm);
+
+/// Set coin boxes, ids are pool slots
+/// < p Coin pool
+/// < bp Box set
+void set_coin_boxes(POOL* p, BROADPHASE* bp);
 
-/// Draw a coin
-/// < o Coin to draw
-void coin_draw(COIN* o);
+/// Draw coins
+/// < p Coin pool
+void draw_coins(POOL* p);
 
-/// Push an coin to the game world
-/// < o Coin to push
+/// Push a coin to the game world
+/// < p Coin pool
+/// < r Random number generator
 /// < x X coordinate
 /// < y Y coordinate
-void push_coin(COIN* o, float x, float y);
+/// > Slot index, -1 if the pool is full
+int push_coin(POOL* p, RNG* r, FIXED x, FIXED y);
 
-#endif // __COIN__
\ No newline at end of file
+#endif // __COIN__
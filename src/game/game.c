@@ -9,194 +9,86 @@
 #include "../engine/controls.h"
 #include "../engine/assets.h"
 #include "../engine/transform.h"
+#include "../engine/transition.h"
+#include "../engine/fixed.h"
 
-#include "stage.h"
-#include "player.h"
-#include "obstacle.h"
-#include "coin.h"
+#include "world.h"
 
 #include "stdio.h"
 #include "stdlib.h"
 #include "math.h"
 #include "time.h"
 
-/// Player
-static PLAYER pl;
-/// Obstacles
-#define OBS_COUNT 8
-static OBSTACLE obstacles[OBS_COUNT];
-/// Coins
-#define COIN_COUNT 12
-static COIN coins[COIN_COUNT];
-/// Obstacle timer
-static float interval;
-static float obsTimer;
-/// Fish timer
-static float fishTimer;
-/// Phase
-static int phase;
-/// Interval count
-static int intervalCount;
-/// Interval goal
-static int intervalGoal;
-/// Goal create
-static bool goalCreated;
-
-/// Bitmap font
-static BITMAP* bmpFont;
-/// Bitmap font 2
-static BITMAP* bmpFont2;
-/// Heart bitmap
-static BITMAP* bmpHeart;
-/// Game over bitmap
-static BITMAP* bmpGameOver;
-/// Great! bitmap
-static BITMAP* bmpGreat;
+/// Game world
+static WORLD* world;
+/// Random seed, 0 for a time-based seed
+static Uint32 seed = 0;
+/// Obstacle capacity
+static int obsCapacity = 8;
+/// Coin capacity
+static int coinCapacity = 12;
+
+/// Bitmap font handle
+static int hFont;
+/// Bitmap font 2 handle
+static int hFont2;
+/// Heart bitmap handle
+static int hHeart;
+/// Game over bitmap handle
+static int hGameOver;
+/// Great! bitmap handle
+static int hGreat;
 
 /// Game over frame
 static FRAME* goverFrame;
 /// Is the game over
 static bool gameOver;
 /// Game over timer
-static float goverTimer;
+static FIXED goverTimer;
 /// Draw money text
 static bool drawMoney;
 /// Hint index
 static int hintIndex;
 
-/// Push obstacle to the game world
-static void push_obs()
-{
-    if(goalCreated) return;
-
-    int index = rand() % 3;
-
-    intervalCount ++;
-    if(intervalCount == intervalGoal)
-    {
-        goalCreated = true;
-        index = 4;
-    }
-
-    int i = 0;
-    for(; i < OBS_COUNT; i++)
-    {
-        if(obstacles[i].exist == false)
-        {
-            push_obstacle(&obstacles[i],index);
-            return;
-        }
-    }
-}
-
-/// Push coins
-static void push_coins()
-{   
-    int m = intervalCount < 10 ? 5 : 3;
-
-    if(rand() % m == 0 || goalCreated) return;
-
-    float posy = 24 + (float) (rand() % 48) ;
-    float posx = 128 + (float) (rand() % 24 + 16);
-
-    int loop = 0;
-    int loopMax = rand() % 2 + 1;
-    if(rand() % 2 == 0) loopMax ++;
-    if(rand() % 2 == 0) loopMax ++;
-    int i = 0;
-
-    int dist = loopMax == 2 ? 16 : 12;
-
-    for(; loop < loopMax; loop++ )
-    {
-        for(i=0; i < COIN_COUNT; i++)
-        {
-            if(coins[i].exist == false)
-            {
-                push_coin(&coins[i],posx + (float)loop*dist, posy );
-                break;
-            }
-        }
-    }
-}
-
-/// Push some nice fish
-static void push_fish()
-{
-    if(goalCreated)
-        return;
-
-    int i = 0;
-    for(; i < OBS_COUNT; i++)
-    {
-        if(obstacles[i].exist == false)
-        {
-            push_obstacle(&obstacles[i], 3);
-            return;
-        }
-    }
-}
-
 /// Reset game
 static void game_reset()
 {
-    init_stage();
-    pl = create_player();
-    int i = 0;
-    for(; i < OBS_COUNT; i++)
-        obstacles[i] = create_obstacle();
-    for(i=0; i < COIN_COUNT; i++)
-        coins[i] = create_coin();
+    // The game over snapshot is no longer needed
+    frame_release(goverFrame);
+    goverFrame = NULL;
+
+    reset_world(world);
 
-    // Set default values
-    phase = 0;
-    interval = 90.0f;
-    obsTimer = interval;
-    fishTimer = interval * (0.5f + (float)(rand() % 3 + 1));
     gameOver = false;
-    goverTimer = 0.0f;
-    intervalCount = 0;
-    intervalGoal = 20;
-    goalCreated = false;
+    goverTimer = 0;
 }
 
 /// Init game
 static int game_init()
 {
-    /// Initialize components
-    init_stage();
-    pl = create_player();
-    int i = 0;
-    for(; i < OBS_COUNT; i++)
-        obstacles[i] = create_obstacle();
-    for(i=0; i < COIN_COUNT; i++)
-        coins[i] = create_coin();
+    world = create_world(obsCapacity,coinCapacity,default_tuning(),
+        seed != 0 ? seed : (Uint32)time(NULL));
+    if(world == NULL)
+    {
+        printf("Failed to allocate memory for entities!\n");
+        return 1;
+    }
 
     // Set default values
-    phase = 0;
-    interval = 90.0f;
-    obsTimer = interval;
-    fishTimer = interval * (0.5f + (float)(rand() % 3 + 1));
     gameOver = false;
     hintIndex = 0;
-    goverTimer = 0.0f;
-    intervalCount = 0;
-    intervalGoal = 20;
-    goalCreated = false;
+    goverTimer = 0;
     drawMoney = false;
 
     // Get bitmaps
-    bmpFont = get_bitmap("font");
-    bmpHeart = get_bitmap("heart");
-    bmpGameOver = get_bitmap("gameover");
-    bmpFont2 = get_bitmap("font2");
-    bmpGreat = get_bitmap("great");
+    hFont = get_asset_handle("font");
+    hHeart = get_asset_handle("heart");
+    hGameOver = get_asset_handle("gameover");
+    hFont2 = get_asset_handle("font2");
+    hGreat = get_asset_handle("great");
 
-    // Create frame
-    goverFrame = frame_create(128,96);
-    if(goverFrame == NULL) return 1;
-
-    srand(time(NULL));
+    // Game over frame is taken from the frame pool when needed
+    goverFrame = NULL;
 
     return 0;
 }
@@ -205,11 +97,14 @@ static int game_init()
 /// tm Time multiplier
 static void game_update(float tm)
 {
+    // The simulation runs in fixed-point
+    FIXED step = fx_from_float(tm);
+
     // Update game over screne
     if(gameOver)
     {
-        if(goverTimer > 0.0f)
-            goverTimer -= 1.0f * tm;
+        if(goverTimer > 0)
+            goverTimer -= step;
         else
         {
             if(any_pressed())
@@ -222,52 +117,23 @@ static void game_update(float tm)
         return;
     }
 
-    // Update components
-    update_stage(&pl,tm);
-    pl_update(&pl,tm);
-    int i = 0;
-    for(; i < 8; i++)
-        ob_update(&obstacles[i],&pl,tm);
-    for(i=0; i < 8; i++)
-        coin_update(&coins[i],&pl,tm);
-
-    // Update obstacle timer
-    float speed = get_global_speed();
-    obsTimer -= speed * tm;
-    // Create a new obstacle
-    if(obsTimer <= 0.0f)
-    {
-        obsTimer += interval;
-        push_obs();
-        push_coins();
-    }
-    
-    // Update fish timer
-    fishTimer -= speed * tm;
-    if(fishTimer <= 0.0f)
-    {
-        int min = (phase < 2) ? 3-phase : 1; 
-        int max = (phase < 2) ? 5 : ((phase < 5) ? 5-phase : 0);
-        fishTimer += interval * ( (max > 0 ? rand() % max : 0 ) + min);
-        push_fish();
-    }
-
-    // Set phase & interval
-    phase = (int)floor(pl.money / 10);
-    interval = 100.0f - phase*7.5f;
-    intervalGoal = 20 + pl.money * (phase+1);
+    // Update the world
+    PL_INPUT in = (PL_INPUT){any_pressed(),any_down(),any_released()};
+    update_world(world,in,step);
 
     // Game over?
     drawMoney = true;
-    if(pl.health <= 0 || pl.victorous)
+    if(world_is_over(world))
     {
         drawMoney = false;
         game_draw();
-        copy_frame(get_current_frame(),goverFrame);
+        goverFrame = frame_acquire(128,96);
+        if(goverFrame != NULL)
+            copy_frame(get_current_frame(),goverFrame);
         drawMoney = true;
-        goverTimer = 30.0f;
+        goverTimer = fx_int(30);
         gameOver = true;
-        hintIndex = rand () % 3;
+        hintIndex = rng_int(&world->rng,3);
     }
 
 }
@@ -279,31 +145,31 @@ void game_draw()
 
     if(gameOver)
     {
-        draw_inverted_bitmap((BITMAP*)goverFrame,0,0,0);
+        if(goverFrame != NULL)
+            draw_inverted_bitmap((BITMAP*)goverFrame,0,0,0);
 
-        if(goverTimer > 0.0f)
+        if(goverTimer > 0 && goverFrame != NULL)
         {
-            int skip = (int)floor(goverTimer / 5.0f) +1;
-            draw_skipped_bitmap_region((BITMAP*)goverFrame,0,0,128,96,0,0,skip,skip,0);
+            draw_dissolve((BITMAP*)goverFrame,0,0,128,96,0,0,DISSOLVE_BAYER,fx_to_float(goverTimer) / 30.0f);
         }
         else
         {
-            if(pl.victorous)
+            if(world->pl.victorous)
             {
-                draw_bitmap(bmpGreat,64-32,16,0);
-                draw_text(bmpFont2,(Uint8*)"You beat the\ngame... and\nno one cares!",64,16,44,-1,12,false);
+                draw_bitmap(get_bitmap_handle(hGreat),64-32,16,0);
+                draw_text(get_bitmap_handle(hFont2),(Uint8*)"You beat the\ngame... and\nno one cares!",64,16,44,-1,12,false);
             }
             else
             {
-                draw_bitmap(bmpGameOver,0,16,0);
+                draw_bitmap(get_bitmap_handle(hGameOver),0,16,0);
 
                 // The Ludum Dare way to do these things:
                 if(hintIndex == 0)
-                    draw_text(bmpFont2,(Uint8*)"HINT: Collect\nmore money!",64,16,48,-1,12,false);
+                    draw_text(get_bitmap_handle(hFont2),(Uint8*)"HINT: Collect\nmore money!",64,16,48,-1,12,false);
                 else if(hintIndex == 1)
-                    draw_text(bmpFont2,(Uint8*)"HINT: Want to win?\nCollect money!",64,1,48,-1,12,false);
+                    draw_text(get_bitmap_handle(hFont2),(Uint8*)"HINT: Want to win?\nCollect money!",64,1,48,-1,12,false);
                 else if(hintIndex == 2)
-                    draw_text(bmpFont2,(Uint8*)"HINT: Money is\nyour goal!",64,12,48,-1,12,false);
+                    draw_text(get_bitmap_handle(hFont2),(Uint8*)"HINT: Money is\nyour goal!",64,12,48,-1,12,false);
 
             }
         }
@@ -312,33 +178,20 @@ void game_draw()
     }
 
     // Draw components
-    draw_stage();
-    int i = 0;
-    for(; i < COIN_COUNT; i++)
-    {
-        coin_draw(&coins[i]);
-    }
-    for(i=0; i < OBS_COUNT; i++)
-    {
-        if(obstacles[i].type != O_FISH) ob_draw(&obstacles[i]);
-    }
-    for(i=0; i < OBS_COUNT; i++)
-    {
-        if(obstacles[i].type == O_FISH) ob_draw(&obstacles[i]);
-    }
-    pl_draw(&pl);
+    draw_world(world);
 
     // Draw money
     if(drawMoney)
     {
         char moneyStr[32];
-        snprintf(moneyStr,32,"MONEY: $%d",pl.money);
-        draw_text(bmpFont,(Uint8*)moneyStr,32, 24,2, 0,0, false);
+        snprintf(moneyStr,32,"MONEY: $%d",world->pl.money);
+        draw_text(get_bitmap_handle(hFont),(Uint8*)moneyStr,32, 24,2, 0,0, false);
 
         // Draw hearts
-        for(i=0; i < pl.health; i++)
+        int i = 0;
+        for(; i < world->pl.health; i++)
         {
-            draw_bitmap(bmpHeart,1,2 + i*13,0);
+            draw_bitmap(get_bitmap_handle(hHeart),1,2 + i*13,0);
         }
     }
 }
@@ -346,9 +199,24 @@ void game_draw()
 /// Destroy game
 static void game_destroy()
 {
+    destroy_stage();
+    destroy_world(world);
     destroy_assets();
 }
 
+/// Set entity capacities
+void set_entity_capacity(int obs, int coin)
+{
+    if(obs > 0) obsCapacity = obs;
+    if(coin > 0) coinCapacity = coin;
+}
+
+/// Set the random seed
+void set_game_seed(Uint32 s)
+{
+    seed = s;
+}
+
 /// Get game scene
 SCENE get_game_scene()
 {
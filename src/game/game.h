@@ -6,6 +6,8 @@
 
 #include "../engine/scene.h"
 
+#include "SDL2/SDL.h"
+
 /// Get game scene
 /// > Game scene
 SCENE get_game_scene();
@@ -13,4 +15,16 @@ SCENE get_game_scene();
 /// Draw game
 void game_draw();
 
+/// Set entity capacities, must be called before the
+/// scene is initialized
+/// < obs Maximum amount of obstacles
+/// < coin Maximum amount of coins
+void set_entity_capacity(int obs, int coin);
+
+/// Set the random seed, must be called before the
+/// scene is initialized. The same seed and input give
+/// the same game
+/// < s Seed, 0 for a time-based seed
+void set_game_seed(Uint32 s);
+
 #endif // __GAME_SCENE__
\ No newline at end of file
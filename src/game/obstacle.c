@@ -5,102 +5,129 @@
 
 #include "../engine/graphics.h"
 #include "../engine/assets.h"
+#include "../engine/trig.h"
 
 #include "player.h"
-#include "stage.h"
 
 #include "stdlib.h"
+#include "string.h"
 #include "math.h"
 
-/// Obstacle bitmap
-static BITMAP* bmpObstacle =NULL;
-/// Fish bitmap
-static BITMAP* bmpFish =NULL;
+/// Obstacle bitmap handle
+static int hObstacle = -1;
+/// Fish bitmap handle
+static int hFish = -1;
 
-/// Create an obstacle (that does not exist)
-OBSTACLE create_obstacle()
+/// Maximum amount of drawn parts in an obstacle
+#define MAX_PARTS 16
+
+/// Drawn part of an obstacle
+typedef struct
+{
+    SDL_Rect src; /// Source region
+    int x; /// X coordinate
+    int y; /// Y coordinate
+    bool solid; /// Does the part hurt
+    bool fish; /// Is the part from the fish bitmap
+}
+PART;
+
+/// Add a drawn part
+/// < parts Parts
+/// < n Part count
+/// < sx Source X
+/// < sy Source Y
+/// < sw Source W
+/// < sh Source H
+/// < x X coordinate
+/// < y Y coordinate
+/// < solid Does the part hurt
+/// < fish Is the part from the fish bitmap
+static void add_part(PART* parts, int* n, int sx, int sy, int sw, int sh, int x, int y, bool solid, bool fish)
 {
-    if(bmpObstacle == NULL)
-        bmpObstacle = get_bitmap("obstacles");
+    if(*n >= MAX_PARTS) return;
+
+    parts[*n] = (PART){(SDL_Rect){sx,sy,sw,sh},x,y,solid,fish};
+    (*n) ++;
+}
 
-    if(bmpFish == NULL)
-        bmpFish = get_bitmap("fish");
+/// Create an obstacle pool
+POOL* create_obstacle_pool(int capacity)
+{
+    if(hObstacle == -1)
+        hObstacle = get_asset_handle("obstacles");
 
-    OBSTACLE o;
-    o.fishSpr = create_sprite(24,12);
-    o.exist = false;
+    if(hFish == -1)
+        hFish = get_asset_handle("fish");
 
-    return o;
+    return create_pool(capacity,sizeof(OBSTACLE));
 }
 
-/// Update obstacle
-void ob_update(OBSTACLE* o, PLAYER* pl, float tm)
+/// Update an obstacle
+/// < p Obstacle pool
+/// < s Slot
+/// < pl Player object
+/// < r Random number generator
+/// < speed Global speed
+/// < tm Time mul.
+static void ob_update(POOL* p, int s, PLAYER* pl, RNG* r, FIXED speed, FIXED tm)
 {
-    if(o->exist == false) return;
+    OBSTACLE* o = (OBSTACLE*)pool_cold(p,s);
+    int type = p->type[s];
 
-    float speed = get_global_speed();
-    if(o->type == O_FISH) speed *= 1.5f;
-    o->pos.x -= speed * tm;
-    if( (o->type == O_FISH && o->pos.x < -24) || (o->type != O_FISH && o->pos.x < -16))
+    if(type == O_FISH) speed = fx_mul(speed,fx(1.5));
+    p->vx[s] = -speed;
+    p->x[s] += fx_mul(p->vx[s],tm);
+    if( (type == O_FISH && p->x[s] < fx_int(-24)) || (type != O_FISH && p->x[s] < fx_int(-16)))
     {
-        o->exist = false;
+        pool_despawn(p,s);
         return;
     }
 
     // Type specific behaviour
-    switch(o->type)
+    switch(type)
     {
     case O_PLANT:
     {
-        o->anim += 1.0f * tm;
-        o->gravity += 0.05f * tm;
-        if(o->gravity > 2.0f)
-            o->gravity = 2.0f;
-        o->pos.y += o->gravity *tm;
-        if(o->pos.y > 96-24 && o->gravity >= 0.0f)
+        o->anim += tm;
+        o->gravity += fx_mul(fx(0.05),tm);
+        if(o->gravity > fx_int(2))
+            o->gravity = fx_int(2);
+        p->y[s] += fx_mul(o->gravity,tm);
+        if(p->y[s] > fx_int(96-24) && o->gravity >= 0)
         {
-            o->gravity = 0.0f;
-            o->pos.y = 96-24;
+            o->gravity = 0;
+            p->y[s] = fx_int(96-24);
         }
 
         if(!o->jumped)
         {
-            o->jumpTimer -= 1.0f * tm;
-            if(o->jumpTimer <= 0.0f)
+            o->jumpTimer -= tm;
+            if(o->jumpTimer <= 0)
             {
-                o->gravity = -1.00f - (float) (rand() % 150) / 100.0f;
+                o->gravity = -FIXED_ONE - fx_int(rng_int(r,150)) / 100;
                 o->jumped = true;
             }
         }
-
-        pl_hurt(pl,vec2(o->pos.x+2,o->pos.y+2),vec2(8.0f,8.0f));
     }
     break;
 
     case O_FLYING:
     {
-        o->waveTimer += 0.05f * tm;
-        o->pos.y = o->startY + sin(o->waveTimer) * o->waveLength;
-        pl_hurt(pl,vec2(o->pos.x+2,o->pos.y+2),vec2(8.0f,8.0f + 12.0f* (o->height-1)));
-    }
-    break;
-
-    case O_POLE:
-    {
-        pl_hurt(pl,vec2(o->pos.x+2,o->pos.y+2),vec2(8.0f,8.0f + 12.0f* (o->height-1)));
+        // The height is set from the batched waves
+        p->phase[s] += fx_mul(fx(0.05),tm);
     }
     break;
 
     case O_FISH:
     {
-        spr_animate(&o->fishSpr,0,0,3,6,tm);
-        pl_hurt(pl,vec2(o->pos.x+2,o->pos.y+2),vec2(20.0f,8.0f));
+        spr_animate(&o->fishSpr,0,0,3,fx_int(6),tm);
     }
     break;
 
     case O_GOAL:
     {
-        if(pl->pos.x >= o->pos.x+12)
+        if(pl->pos.x >= p->x[s]+fx_int(12))
         {
             pl->victorous = true;
         }
@@ -112,115 +139,254 @@ void ob_update(OBSTACLE* o, PLAYER* pl, float tm)
     }
 }
 
-/// Draw obstacle
-void ob_draw(OBSTACLE* o)
+/// Get the drawn parts of an obstacle
+/// < p Obstacle pool
+/// < s Slot
+/// < parts Parts, at least MAX_PARTS
+/// > Part count
+static int ob_parts(POOL* p, int s, PART* parts)
 {
-    if(o->exist == false) return;
+    OBSTACLE* o = (OBSTACLE*)pool_cold(p,s);
+    int x = fx_round(p->x[s]);
+    int y = fx_round(p->y[s]);
+    int n = 0;
+    int i;
 
-    switch(o->type)
+    switch(p->type[s])
     {
     case O_PLANT:
     {
-        int frame = (int)floor(o->anim/8.0f) % 2;
-        draw_bitmap_region(bmpObstacle,12*frame,48,12,12,(int)round(o->pos.x),(int)round(o->pos.y),0);
+        int frame = fx_floor(o->anim/8) % 2;
+        add_part(parts,&n,12*frame,48,12,12,x,y,true,false);
     }
     break;
 
     case O_POLE:
     {
-        draw_bitmap_region(bmpObstacle,0,0,12,12,(int)round(o->pos.x),(int)round(o->pos.y),0);
-        draw_bitmap_region(bmpObstacle,0,36,12,12,(int)round(o->pos.x),96-24,0);
+        add_part(parts,&n,0,0,12,12,x,y,true,false);
+        add_part(parts,&n,0,36,12,12,x,96-24,true,false);
         if(o->height > 2)
         {
-            draw_bitmap_region(bmpObstacle,0,12,12,12,(int)round(o->pos.x),(int)round(o->pos.y) + 12,0);
+            add_part(parts,&n,0,12,12,12,x,y + 12,true,false);
         }
 
-        int i = 0;
-        for(; i < o->height-3; i++)
+        for(i=0; i < o->height-3; i++)
         {
-            draw_bitmap_region(bmpObstacle,0,24,12,12,(int)round(o->pos.x),(int)round(o->pos.y) + (i+2)*12,0);
+            add_part(parts,&n,0,24,12,12,x,y + (i+2)*12,true,false);
         }
     }
     break;
 
     case O_FLYING:
     {
-        int i = -1;
-        for(; i < (int)floor(o->pos.y/12); i++)
+        // The chain does not hurt
+        for(i=-1; i < fx_floor(p->y[s]/12); i++)
         {
-            draw_bitmap_region(bmpObstacle,12,0,12,12,(int)round(o->pos.x),i*12 + (int)(o->pos.y-o->startY),0);
+            add_part(parts,&n,12,0,12,12,x,i*12 + fx_floor(p->y[s]-o->startY),false,false);
         }
 
-        draw_bitmap_region(bmpObstacle,12,12,12,12,(int)round(o->pos.x),(int)round(o->pos.y) -12,0);
-        draw_bitmap_region(bmpObstacle,12,24,12,12,(int)round(o->pos.x),(int)round(o->pos.y),0);
+        add_part(parts,&n,12,12,12,12,x,y -12,false,false);
+        add_part(parts,&n,12,24,12,12,x,y,true,false);
         if(o->height > 1)
         {
-            draw_bitmap_region(bmpObstacle,12,36,12,12,(int)round(o->pos.x),(int)round(o->pos.y) + 12,0);
+            add_part(parts,&n,12,36,12,12,x,y + 12,true,false);
         }
     }
     break;
 
     case O_FISH:
     {
-        spr_draw(&o->fishSpr,bmpFish,o->pos.x,o->pos.y,0);
+        SPRITE* spr = &o->fishSpr;
+        add_part(parts,&n,spr->w*spr->frame,spr->h*spr->row,spr->w,spr->h,
+            fx_floor(p->x[s]),fx_floor(p->y[s]),true,true);
     }
     break;
 
     case O_GOAL:
     {
-        draw_bitmap_region(bmpObstacle,0,60,24,24,o->pos.x,o->pos.y,0);
+        add_part(parts,&n,0,60,24,24,fx_floor(p->x[s]),fx_floor(p->y[s]),false,false);
     }
     break;
 
     default:
         break;
     }
+
+    return n;
+}
+
+/// Draw an obstacle
+/// < p Obstacle pool
+/// < s Slot
+/// < bmpObstacle Obstacle bitmap
+/// < bmpFish Fish bitmap
+static void ob_draw(POOL* p, int s, BITMAP* bmpObstacle, BITMAP* bmpFish)
+{
+    PART parts[MAX_PARTS];
+    int n = ob_parts(p,s,parts);
+    int i = 0;
+    for(; i < n; i++)
+    {
+        draw_bitmap_region(parts[i].fish ? bmpFish : bmpObstacle,
+            parts[i].src.x,parts[i].src.y,parts[i].src.w,parts[i].src.h,parts[i].x,parts[i].y,0);
+    }
+}
+
+/// Draw obstacles
+void draw_obstacles(POOL* p)
+{
+    BITMAP* bmpObstacle = get_bitmap_handle(hObstacle);
+    BITMAP* bmpFish = get_bitmap_handle(hFish);
+
+    int i = 0;
+    for(; i < p->count; i++)
+    {
+        if(p->type[p->live[i]] != O_FISH) ob_draw(p,p->live[i],bmpObstacle,bmpFish);
+    }
+    for(i=0; i < p->count; i++)
+    {
+        if(p->type[p->live[i]] == O_FISH) ob_draw(p,p->live[i],bmpObstacle,bmpFish);
+    }
+}
+
+/// Update obstacles
+void update_obstacles(POOL* p, PLAYER* pl, RNG* r, FIXED speed, FIXED tm)
+{
+    // Backwards, since despawning moves the last one
+    int i = p->count-1;
+    for(; i >= 0; i--)
+    {
+        ob_update(p,p->live[i],pl,r,speed,tm);
+    }
+
+    // The waves of all the flying ones at once
+    int n = 0;
+    int s;
+    OBSTACLE* o;
+    for(i=0; i < p->count; i++)
+    {
+        s = p->live[i];
+        if(p->type[s] == O_FLYING)
+            p->wave[n ++] = p->phase[s];
+    }
+    fx_sin_batch(p->wave,p->wave,n);
+
+    n = 0;
+    for(i=0; i < p->count; i++)
+    {
+        s = p->live[i];
+        if(p->type[s] != O_FLYING) continue;
+
+        o = (OBSTACLE*)pool_cold(p,s);
+        p->y[s] = o->startY + fx_mul(p->wave[n ++],o->waveLength);
+    }
+}
+
+/// Set obstacle hit boxes
+void set_obstacle_boxes(POOL* p, BROADPHASE* bp)
+{
+    bp_begin(bp);
+
+    PART parts[MAX_PARTS];
+    int i = 0;
+    int k,n,s;
+    int x0,y0,x1,y1;
+    for(; i < p->count; i++)
+    {
+        s = p->live[i];
+        n = ob_parts(p,s,parts);
+
+        // Bounds of the parts that hurt
+        x0 = y0 = 0x7FFFFFFF;
+        x1 = y1 = -0x7FFFFFFF;
+        for(k=0; k < n; k++)
+        {
+            if(!parts[k].solid) continue;
+
+            if(parts[k].x < x0) x0 = parts[k].x;
+            if(parts[k].y < y0) y0 = parts[k].y;
+            if(parts[k].x + parts[k].src.w > x1) x1 = parts[k].x + parts[k].src.w;
+            if(parts[k].y + parts[k].src.h > y1) y1 = parts[k].y + parts[k].src.h;
+        }
+
+        if(x1 > x0)
+            bp_set(bp,s,x0,y0,x1-x0,y1-y0);
+    }
+
+    bp_end(bp);
+}
+
+/// Test an obstacle against a mask
+bool ob_hits_mask(POOL* p, int s, MASK* m, SDL_Rect r, int x, int y)
+{
+    MASK* obsMask = get_mask_handle(hObstacle);
+    MASK* fishMask = get_mask_handle(hFish);
+
+    PART parts[MAX_PARTS];
+    int n = ob_parts(p,s,parts);
+    int i = 0;
+    MASK* pm;
+    for(; i < n; i++)
+    {
+        pm = parts[i].fish ? fishMask : obsMask;
+        if(parts[i].solid && pm != NULL
+            && mask_overlap(pm,parts[i].src,parts[i].x,parts[i].y,m,r,x,y))
+            return true;
+    }
+
+    return false;
 }
 
 /// Push an obstacle to the game world
-void push_obstacle(OBSTACLE* o, int type)
+int push_obstacle(POOL* p, RNG* r, int type)
 {
-    o->type = type;
-    o->pos.x = 128;
+    int s = pool_spawn(p,type);
+    if(s == -1) return -1;
+
+    // Clear what the previous occupant left, the block is saved whole
+    OBSTACLE* o = (OBSTACLE*)pool_cold(p,s);
+    memset(o,0,sizeof(OBSTACLE));
+    o->fishSpr = create_sprite(24,12);
+    p->x[s] = fx_int(128);
     
     switch(type)
     {
     case O_PLANT:
     {
-        o->anim = 0.0f;
-        o->pos.y = 96-24;
-        o->jumpTimer = (float)(rand() % 60 + 15);
+        o->anim = 0;
+        p->y[s] = fx_int(96-24);
+        o->jumpTimer = fx_int(rng_int(r,60) + 15);
         o->jumped = false;
     }
     break;
 
     case O_POLE:
     {
-        int height = rand() % 2 + 2;
-        o->pos.y = 96-12 - height*12;
+        int height = rng_int(r,2) + 2;
+        p->y[s] = fx_int(96-12 - height*12);
         o->height = height;
     }
     break;
 
     case O_FLYING:
     {
-        int height = rand() % 2 + 1;
-        o->pos.y = (2 + rand() % 3) * 12;
+        int height = rng_int(r,2) + 1;
+        p->y[s] = fx_int((2 + rng_int(r,3)) * 12);
         o->height = height;
-        o->waveLength = (float)(rand() % 16 + 4);
+        o->waveLength = fx_int(rng_int(r,16) + 4);
     }
     break;
 
     case O_FISH:
     {
-        o->pos.x += (float) (rand() % 24);
-        o->pos.y = 24 + (float) (rand() % 48 );
+        p->x[s] += fx_int(rng_int(r,24));
+        p->y[s] = fx_int(24 + rng_int(r,48));
     }
     break;
 
     case O_GOAL:
     {
-        o->pos.y = 96-36;
+        p->y[s] = fx_int(96-36);
     }
     break;
 
@@ -228,6 +394,7 @@ void push_obstacle(OBSTACLE* o, int type)
         break;
     }
 
-    o->startY = o->pos.y;
-    o->exist = true;
+    o->startY = p->y[s];
+
+    return s;
 }
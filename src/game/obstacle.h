@@ -6,6 +6,12 @@
 
 #include "player.h"
 
+#include "../engine/pool.h"
+#include "../engine/broadphase.h"
+#include "../engine/mask.h"
+#include "../engine/fixed.h"
+#include "../engine/rng.h"
+
 #include "stdbool.h"
 
 /// Obstacle types
@@ -18,41 +24,58 @@ enum
     O_GOAL = 4,
 };
 
-/// Obstacle structure
+/// Obstacle data, position and type are kept in the pool
 typedef struct
 {
-    VEC2 pos;
-    float startY;
-    float gravity;
-    int type;
+    FIXED startY;
+    FIXED gravity;
     int height;
-    float anim;
-    float jumpTimer;
-    float waveLength;
-    float waveTimer;
-    bool exist;
+    FIXED anim;
+    FIXED jumpTimer;
+    FIXED waveLength;
     SPRITE fishSpr;
     bool jumped;
 
 }OBSTACLE;
 
-/// Create an obstacle (that does not exist)
-/// > Obstacle
-OBSTACLE create_obstacle();
+/// Create an obstacle pool
+/// < capacity Maximum amount of obstacles
+/// > A new pool, NULL on error
+POOL* create_obstacle_pool(int capacity);
 
-/// Update obstacle
-/// < o Obstacle to update
+/// Update obstacles
+/// < p Obstacle pool
 /// < pl Player object
+/// < r Random number generator
+/// < speed Global speed
 /// < tm Time mul.
-void ob_update(OBSTACLE* o, PLAYER* pl, float tm);
+void update_obstacles(POOL* p, PLAYER* pl, RNG* r, FIXED speed, FIXED tm);
+
+/// Draw obstacles, fish on top of the rest
+/// < p Obstacle pool
+void draw_obstacles(POOL* p);
+
+/// Set obstacle hit boxes, ids are pool slots. A box
+/// bounds the parts of an obstacle that hurt
+/// < p Obstacle pool
+/// < bp Box set
+void set_obstacle_boxes(POOL* p, BROADPHASE* bp);
 
-/// Draw obstacle
-/// < o Obstacle to draw
-void ob_draw(OBSTACLE* o);
+/// Test the parts of an obstacle that hurt against a mask
+/// < p Obstacle pool
+/// < s Slot
+/// < m Mask
+/// < r Source region in the mask
+/// < x X coordinate of the region
+/// < y Y coordinate of the region
+/// > True if the pixels overlap
+bool ob_hits_mask(POOL* p, int s, MASK* m, SDL_Rect r, int x, int y);
 
 /// Push an obstacle to the game world
-/// < o Obstacle to push
+/// < p Obstacle pool
+/// < r Random number generator
 /// < type Type
-void push_obstacle(OBSTACLE* o, int type);
+/// > Slot index, -1 if the pool is full
+int push_obstacle(POOL* p, RNG* r, int type);
 
-#endif // __OBSTACLE__
\ No newline at end of file
+#endif // __OBSTACLE__
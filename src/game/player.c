@@ -5,66 +5,63 @@
 
 #include "../engine/assets.h"
 #include "../engine/graphics.h"
-#include "../engine/controls.h"
+#include "../engine/state.h"
 
 #include "math.h"
 
-#include "stage.h"
-
-/// Player bitmap
-static BITMAP* bmpPlayer = NULL;
+/// Player bitmap handle
+static int hPlayer = -1;
 
 /// Controls
-static void pl_control(PLAYER*pl)
+static void pl_control(PLAYER*pl, PL_INPUT in)
 {
-    if(any_pressed())
+    if(in.pressed)
     {
         if(pl->canJump)
         {
-            pl->gravity = -2.25f;
+            pl->gravity = fx(-2.25);
             pl->doubleJump = true;
             pl->canJump = false;
         }
         else if(pl->doubleJump)
         {
-            pl->gravity = -1.75f;
+            pl->gravity = fx(-1.75);
             pl->doubleJump = false;
         }
     }
 
-    pl->spinning = (any_down() && !pl->doubleJump && pl->gravity > 0.0f && !pl->canJump);
+    pl->spinning = (in.down && !pl->doubleJump && pl->gravity > 0 && !pl->canJump);
     
-    if(!pl->canJump && any_released() && pl->gravity < 0.0f)
+    if(!pl->canJump && in.released && pl->gravity < 0)
     {
-        pl->gravity /= 1.75f;
+        pl->gravity = fx_div(pl->gravity,fx(1.75));
     }
 }
 
 /// Animate
-static void pl_animate(PLAYER*pl, float tm)
+static void pl_animate(PLAYER*pl, FIXED speed, FIXED tm)
 {
     if(pl->canJump)
     {
-        float speed = get_global_speed();
-        spr_animate(&pl->spr,0,0,5,5.0f-speed,tm);
+        spr_animate(&pl->spr,0,0,5,fx_int(5)-speed,tm);
     }
     else
     {
         if(pl->spinning)
         {
-            spr_animate(&pl->spr,2,0,3,3,tm);
+            spr_animate(&pl->spr,2,0,3,fx_int(3),tm);
         }
         else
         {
 
-            if(pl->doubleJump || pl->gravity > 0.0f)
+            if(pl->doubleJump || pl->gravity > 0)
             {
-                int frame = pl->gravity < 0.0f ? 0 : 1;
+                int frame = pl->gravity < 0 ? 0 : 1;
                 spr_animate(&pl->spr,1,frame,frame,0,tm);
             }
             else 
             {
-                spr_animate(&pl->spr,1,2,5,3,tm);
+                spr_animate(&pl->spr,1,2,5,fx_int(3),tm);
             }
 
         }
@@ -72,50 +69,51 @@ static void pl_animate(PLAYER*pl, float tm)
 }
 
 /// Move
-static void pl_move(PLAYER* pl, float tm)
+static void pl_move(PLAYER* pl, FIXED tm)
 {
-    pl->gravity += 0.075f * tm;
-    if(pl->gravity > 2.0f)
-        pl->gravity = 2.0f;
+    pl->gravity += fx_mul(fx(0.075),tm);
+    if(pl->gravity > fx_int(2))
+        pl->gravity = fx_int(2);
 
     if(pl->spinning)
     {
-        pl->gravity = 0.25f;
+        pl->gravity = fx(0.25);
     }
 
-    pl->pos.y += pl->gravity * tm;
+    pl->pos.y += fx_mul(pl->gravity,tm);
 
     pl->canJump = false;
-    if(pl->pos.y > 96-12)
+    if(pl->pos.y > fx_int(96-12))
     {
-        pl->pos.y = 96-12;
+        pl->pos.y = fx_int(96-12);
         pl->canJump = true;
-        pl->gravity = 0.0f;
+        pl->gravity = 0;
         pl->doubleJump = false;
         pl->spinning = false;
     }
 
-    if(pl->hurtTimer > 0.0f)
-        pl->hurtTimer -= 1.0f * tm;
+    if(pl->hurtTimer > 0)
+        pl->hurtTimer -= tm;
 
-    if(pl->pos.x < 24.0f)
-        pl->pos.x += 0.5f * tm;
+    if(pl->pos.x < fx_int(24))
+        pl->pos.x += fx_mul(fx(0.5),tm);
 }
 
 /// Create a player object
 PLAYER create_player()
 {
-    if(bmpPlayer == NULL)
-        bmpPlayer = get_bitmap("figure");
+    if(hPlayer == -1)
+        hPlayer = get_asset_handle("figure");
 
     PLAYER pl;
-    pl.pos = vec2(-8.0f,96-12);
-    pl.gravity = 0.0f;
+    pl.pos = fxvec2(fx_int(-8),fx_int(96-12));
+    pl.gravity = 0;
     pl.canJump = true;
     pl.doubleJump = false;
+    pl.spinning = false;
     pl.spr = create_sprite(12,16);
     pl.health = 3;
-    pl.hurtTimer = 0.0f;
+    pl.hurtTimer = 0;
     pl.money = 0;
     pl.victorous = false;
 
@@ -123,13 +121,25 @@ PLAYER create_player()
 }
 
 /// Update player
-/// < pl Player to update
-/// < tm Time mul.
-void pl_update(PLAYER* pl, float tm)
+void pl_update(PLAYER* pl, PL_INPUT in, FIXED speed, FIXED tm)
 {
-    pl_control(pl);
+    pl_control(pl,in);
     pl_move(pl,tm);
-    pl_animate(pl,tm);
+    pl_animate(pl,speed,tm);
+}
+
+/// Get the current sprite frame
+void pl_get_frame(PLAYER* pl, SDL_Rect* src, int* x, int* y)
+{
+    *src = (SDL_Rect){pl->spr.w*pl->spr.frame,pl->spr.h*pl->spr.row,pl->spr.w,pl->spr.h};
+    *x = fx_floor(pl->pos.x)-6;
+    *y = fx_floor(pl->pos.y)-16;
+}
+
+/// Get the player collision mask
+MASK* pl_get_mask()
+{
+    return get_mask_handle(hPlayer);
 }
 
 /// Draw player
@@ -137,25 +147,68 @@ void pl_update(PLAYER* pl, float tm)
 void pl_draw(PLAYER* pl)
 {
     int row = pl->spr.row;
-    if(pl->hurtTimer > 0.0f && (int)floor(pl->hurtTimer / 4.0f) % 2 == 1)
+    if(pl->hurtTimer > 0 && fx_floor(pl->hurtTimer / 4) % 2 == 1)
     {
         pl->spr.row += 3;
     }
 
-    spr_draw(&pl->spr,bmpPlayer,pl->pos.x-6,pl->pos.y-16,0);
+    spr_draw(&pl->spr,get_bitmap_handle(hPlayer),fx_floor(pl->pos.x)-6,fx_floor(pl->pos.y)-16,0);
 
     pl->spr.row = row;
 }
 
 /// Make him/her suffer
-void pl_hurt(PLAYER* pl, VEC2 p, VEC2 d)
+void pl_hurt(PLAYER* pl)
 {
-    if(pl->hurtTimer > 0.0f) return;
+    if(pl->hurtTimer > 0) return;
 
-    if(pl->pos.x+2 > p.x && pl->pos.x-2 < p.x+d.x
-        && pl->pos.y-2 > p.y && pl->pos.y-10 < p.y+d.y)
-    {
-        pl->hurtTimer = 60.0f;
-        pl->health --;
-    }
-}
\ No newline at end of file
+    pl->hurtTimer = fx_int(60);
+    pl->health --;
+}
+
+/// Get the size of the player state
+int pl_state_size()
+{
+    return (int)(sizeof(FIXED)*3 + sizeof(bool)*4 + sizeof(int)*4
+        + sizeof(FIXED)*2 + sizeof(int)*2);
+}
+
+/// Save the player state
+Uint8* pl_save(PLAYER* pl, Uint8* out)
+{
+    out = save_bytes(out,&pl->pos.x,sizeof(FIXED));
+    out = save_bytes(out,&pl->pos.y,sizeof(FIXED));
+    out = save_bytes(out,&pl->gravity,sizeof(FIXED));
+    out = save_bytes(out,&pl->canJump,sizeof(bool));
+    out = save_bytes(out,&pl->doubleJump,sizeof(bool));
+    out = save_bytes(out,&pl->spinning,sizeof(bool));
+    out = save_bytes(out,&pl->spr.w,sizeof(int));
+    out = save_bytes(out,&pl->spr.h,sizeof(int));
+    out = save_bytes(out,&pl->spr.frame,sizeof(int));
+    out = save_bytes(out,&pl->spr.row,sizeof(int));
+    out = save_bytes(out,&pl->spr.count,sizeof(FIXED));
+    out = save_bytes(out,&pl->health,sizeof(int));
+    out = save_bytes(out,&pl->money,sizeof(int));
+    out = save_bytes(out,&pl->hurtTimer,sizeof(FIXED));
+    return save_bytes(out,&pl->victorous,sizeof(bool));
+}
+
+/// Load the player state
+const Uint8* pl_load(PLAYER* pl, const Uint8* in)
+{
+    in = load_bytes(in,&pl->pos.x,sizeof(FIXED));
+    in = load_bytes(in,&pl->pos.y,sizeof(FIXED));
+    in = load_bytes(in,&pl->gravity,sizeof(FIXED));
+    in = load_bytes(in,&pl->canJump,sizeof(bool));
+    in = load_bytes(in,&pl->doubleJump,sizeof(bool));
+    in = load_bytes(in,&pl->spinning,sizeof(bool));
+    in = load_bytes(in,&pl->spr.w,sizeof(int));
+    in = load_bytes(in,&pl->spr.h,sizeof(int));
+    in = load_bytes(in,&pl->spr.frame,sizeof(int));
+    in = load_bytes(in,&pl->spr.row,sizeof(int));
+    in = load_bytes(in,&pl->spr.count,sizeof(FIXED));
+    in = load_bytes(in,&pl->health,sizeof(int));
+    in = load_bytes(in,&pl->money,sizeof(int));
+    in = load_bytes(in,&pl->hurtTimer,sizeof(FIXED));
+    return load_bytes(in,&pl->victorous,sizeof(bool));
+}
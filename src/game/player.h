@@ -6,21 +6,32 @@
 
 #include "../engine/vector.h"
 #include "../engine/sprite.h"
+#include "../engine/mask.h"
+#include "../engine/fixed.h"
 
 #include "stdbool.h"
 
+/// Player input
+typedef struct
+{
+    bool pressed; /// Jump pressed this step
+    bool down; /// Jump held down
+    bool released; /// Jump released this step
+}
+PL_INPUT;
+
 /// Player type
 typedef struct
 {
-    VEC2 pos;
-    float gravity;
+    FXVEC2 pos;
+    FIXED gravity;
     bool canJump;
     bool doubleJump;
     bool spinning;
     SPRITE spr;
     int health;
     int money;
-    float hurtTimer;
+    FIXED hurtTimer;
     bool victorous;
 
 }PLAYER;
@@ -31,17 +42,45 @@ PLAYER create_player();
 
 /// Update player
 /// < pl Player to update
+/// < in Input
+/// < speed Global speed
 /// < tm Time mul.
-void pl_update(PLAYER* pl, float tm);
+void pl_update(PLAYER* pl, PL_INPUT in, FIXED speed, FIXED tm);
 
 /// Draw player
 /// < pl Player
 void pl_draw(PLAYER* pl);
 
-/// Make him/her suffer
+/// Make him/her suffer, unless recently hurt
+/// < pl Player
+void pl_hurt(PLAYER* pl);
+
+/// Get the current sprite frame
+/// < pl Player
+/// < src Source region in the player bitmap
+/// < x X coordinate
+/// < y Y coordinate
+void pl_get_frame(PLAYER* pl, SDL_Rect* src, int* x, int* y);
+
+/// Get the player collision mask
+/// > Mask, NULL if not loaded
+MASK* pl_get_mask();
+
+/// Get the size of the player state
+/// > Size in bytes
+int pl_state_size();
+
+/// Save the player state. The fields are written one by one,
+/// so the struct padding is not part of the state
+/// < pl Player
+/// < out Output
+/// > End of the written bytes
+Uint8* pl_save(PLAYER* pl, Uint8* out);
+
+/// Load the player state
 /// < pl Player
-/// < p Position
-/// < d Dimension
-void pl_hurt(PLAYER* pl, VEC2 p, VEC2 d);
+/// < in Input
+/// > End of the read bytes
+const Uint8* pl_load(PLAYER* pl, const Uint8* in);
 
 #endif // __PLAYER__
\ No newline at end of file
@@ -5,103 +5,198 @@
 
 #include "../engine/assets.h"
 #include "../engine/graphics.h"
+#include "../engine/parallax.h"
+#include "../engine/tmaprender.h"
+#include "../engine/transition.h"
+#include "../engine/app.h"
+#include "../engine/state.h"
 
 #include "math.h"
 
-/// Floor pos
-static float fpos;
-/// Global speed
-static float gspeed;
-/// Sky phase
-static int skyPhase;
-/// Old sky phase
-static int oldSky;
-/// Sky change timer
-static float skyChangeTimer;
-
-/// Bitmaps
-static BITMAP* bmpSky;
-static BITMAP* bmpBush;
-static BITMAP* bmpHills;
-static BITMAP* bmpTiles;
+/// Bitmap handles
+static int hSky = -1;
+static int hBush = -1;
+static int hHills = -1;
+static int hTiles = -1;
+
+/// Sky phase count
+#define SKY_PHASES 4
+
+/// Parallax layers
+static PARALLAX* laySky[SKY_PHASES];
+static PARALLAX* layHills;
+static PARALLAX* layBush;
+
+/// Floor tilemap renderer
+static TMAP_RENDERER* floorMap;
+
+/// Compose a layer again if its bitmap has changed
+/// < l Layer
+/// < b Bitmap
+/// < sx Source X
+/// < sy Source Y
+/// < sw Source W
+/// < sh Source H
+static void update_layer(PARALLAX** l, BITMAP* b, int sx, int sy, int sw, int sh)
+{
+    FRAME* canvas = app_get_canvas();
+    if(b == NULL || canvas == NULL || parallax_is_current(*l,b,sx,sy)) return;
+
+    destroy_parallax(*l);
+    *l = create_parallax(b,sx,sy,sw,sh,canvas->w);
+}
+
+/// Compose the layers
+static void update_layers()
+{
+    if(hSky == -1)
+    {
+        hSky = get_asset_handle("sky");
+        hBush = get_asset_handle("bush");
+        hHills = get_asset_handle("hills");
+        hTiles = get_asset_handle("tiles");
+    }
+
+    BITMAP* bmpSky = get_bitmap_handle(hSky);
+    BITMAP* bmp;
+    int i = 0;
+
+    if(bmpSky != NULL)
+    {
+        for(; i < SKY_PHASES; i++)
+        {
+            update_layer(&laySky[i],bmpSky,0,(int)((bmpSky->h/4.0f)*i),bmpSky->w,bmpSky->h/4);
+        }
+    }
+
+    bmp = get_bitmap_handle(hHills);
+    if(bmp != NULL) update_layer(&layHills,bmp,0,0,bmp->w,bmp->h);
+    bmp = get_bitmap_handle(hBush);
+    if(bmp != NULL) update_layer(&layBush,bmp,0,0,bmp->w,bmp->h);
+
+    // The floor renderer follows tileset reloads by itself
+    if(floorMap == NULL)
+    {
+        TILEMAP* t = get_tilemap("floor");
+        if(t != NULL)
+            floorMap = create_tmap_renderer(t,hTiles,0);
+    }
+}
 
 /// Initialize stage
-void init_stage()
+void init_stage(STAGE* s)
 {
-    fpos = 0.0f;
-    gspeed = 1.0f;
-    skyChangeTimer = 0.0f;
-    skyPhase = 0;
-    oldSky = 0;
-
-    bmpSky = get_bitmap("sky");
-    bmpBush  = get_bitmap("bush");
-    bmpHills  = get_bitmap("hills");
-    bmpTiles =  get_bitmap("tiles");
+    s->fpos = 0;
+    s->gspeed = FIXED_ONE;
+    s->skyChangeTimer = 0;
+    s->skyPhase = 0;
+    s->oldSky = 0;
 }
 
 /// Update stage
-void update_stage(PLAYER* pl, float tm)
+void update_stage(STAGE* s, PLAYER* pl, FIXED tm)
 {
-    gspeed = 1.0f + (int)floor(pl->money/5) * 0.1f;
-    skyPhase = (int)floor(pl->money/10);
-    if(skyPhase > 3) skyPhase = 3;
+    s->gspeed = FIXED_ONE + (pl->money/5) * fx(0.1);
+    s->skyPhase = pl->money/10;
+    if(s->skyPhase > 3) s->skyPhase = 3;
 
-    if(skyPhase != oldSky)
+    if(s->skyPhase != s->oldSky)
     {
-        skyChangeTimer = 60.0f;
+        s->skyChangeTimer = fx_int(60);
     }
-    if(skyChangeTimer > 0.0f)
+    if(s->skyChangeTimer > 0)
     {
-        skyChangeTimer -= 2.0f * tm;
+        s->skyChangeTimer -= 2 * tm;
     }
 
-    fpos += gspeed * tm;
-    if(fpos >= 512.0f)
-        fpos -= 512.0f;
+    s->fpos += fx_mul(s->gspeed,tm);
+    if(s->fpos >= fx_int(512))
+        s->fpos -= fx_int(512);
 
-    oldSky = skyPhase;
+    s->oldSky = s->skyPhase;
 }
 
 /// Draw stage
-void draw_stage()
+void draw_stage(STAGE* s)
 {
-    int i = 0;
+    // Reloaded bitmaps are composed again
+    update_layers();
+
+    BITMAP* bmpSky = get_bitmap_handle(hSky);
 
     // Sky
-    if(skyChangeTimer <= 0.0f)
-        draw_bitmap_region(bmpSky,0,(bmpSky->h/4.0f)*skyPhase,bmpSky->w,bmpSky->h/4,0,0,0);
+    if(s->skyChangeTimer <= 0)
+    {
+        if(laySky[s->skyPhase] != NULL) draw_parallax(laySky[s->skyPhase],0,0);
+    }
     else
     {
-        draw_bitmap_region(bmpSky,0,(bmpSky->h/4.0f)*(skyPhase-1),bmpSky->w,bmpSky->h/4,0,0,0);
-        int skip = 6 - (int)floor(skyChangeTimer/10.0f);
-        draw_skipped_bitmap_region(bmpSky,0,(bmpSky->h/4.0f)*(skyPhase),bmpSky->w,bmpSky->h/4,0,0,skip,skip,0);
+        if(s->skyPhase > 0 && laySky[s->skyPhase-1] != NULL) draw_parallax(laySky[s->skyPhase-1],0,0);
+        if(bmpSky != NULL)
+            draw_dissolve(bmpSky,0,(bmpSky->h/4.0f)*(s->skyPhase),bmpSky->w,bmpSky->h/4,0,0,
+                DISSOLVE_BAYER,1.0f - fx_to_float(s->skyChangeTimer)/60.0f);
     }
 
     // Hills
-    int p = -((int) round(fpos/4.0f)) % 128;
-    for(i=0; i <2; i++)
-    {
-        draw_bitmap(bmpHills,p+i*128,24,0);
-    }
+    if(layHills != NULL)
+        draw_parallax(layHills,fx_round(s->fpos/4),24);
 
     // Bush
-    p = -((int) round(fpos/2.0f)) % 64;
-    for(i=0; i <3; i++)
+    if(layBush != NULL)
+        draw_parallax(layBush,fx_round(s->fpos/2),96-12 - 24);
+
+    // Floor, the map repeated across the frame
+    if(floorMap != NULL)
     {
-        draw_bitmap(bmpBush,p+i*64,96-12 - 24,0);
+        int w = floorMap->map->w * floorMap->map->tileW;
+        int x = -(fx_round(s->fpos) % w);
+        if(x > 0) x -= w;
+        for(; x < get_current_frame()->w; x += w)
+        {
+            draw_tilemap(floorMap,x,96-12);
+        }
     }
+}
 
-    // Floor
-    p = -((int)round(fpos)) % 16;
-    for(i=0; i < 9; i++)
+/// Destroy stage
+void destroy_stage()
+{
+    int i = 0;
+    for(; i < SKY_PHASES; i++)
     {
-        draw_bitmap(bmpTiles,p + i*16,96-12,0);
+        destroy_parallax(laySky[i]);
+        laySky[i] = NULL;
     }
+    destroy_parallax(layHills);
+    destroy_parallax(layBush);
+    destroy_tmap_renderer(floorMap);
+    layHills = NULL;
+    layBush = NULL;
+    floorMap = NULL;
+}
+
+/// Get the size of the stage state
+int stage_state_size()
+{
+    return (int)(sizeof(FIXED)*3 + sizeof(int)*2);
 }
 
-/// Get the global speed
-float get_global_speed()
+/// Save the stage state
+Uint8* stage_save(STAGE* s, Uint8* out)
 {
-    return gspeed;
-}
\ No newline at end of file
+    out = save_bytes(out,&s->fpos,sizeof(FIXED));
+    out = save_bytes(out,&s->gspeed,sizeof(FIXED));
+    out = save_bytes(out,&s->skyPhase,sizeof(int));
+    out = save_bytes(out,&s->oldSky,sizeof(int));
+    return save_bytes(out,&s->skyChangeTimer,sizeof(FIXED));
+}
+
+/// Load the stage state
+const Uint8* stage_load(STAGE* s, const Uint8* in)
+{
+    in = load_bytes(in,&s->fpos,sizeof(FIXED));
+    in = load_bytes(in,&s->gspeed,sizeof(FIXED));
+    in = load_bytes(in,&s->skyPhase,sizeof(int));
+    in = load_bytes(in,&s->oldSky,sizeof(int));
+    return load_bytes(in,&s->skyChangeTimer,sizeof(FIXED));
+}
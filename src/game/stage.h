@@ -6,19 +6,50 @@
 
 #include "player.h"
 
+#include "../engine/fixed.h"
+
+/// Stage state. The composed layers are shared
+typedef struct
+{
+    FIXED fpos; /// Floor pos
+    FIXED gspeed; /// Global speed
+    int skyPhase; /// Sky phase
+    int oldSky; /// Old sky phase
+    FIXED skyChangeTimer; /// Sky change timer
+}
+STAGE;
+
 /// Initialize stage
-void init_stage();
+/// < s Stage
+void init_stage(STAGE* s);
 
 /// Update stage
+/// < s Stage
 /// < pl Player
 /// < tm Time mul.
-void update_stage(PLAYER* pl, float tm);
+void update_stage(STAGE* s, PLAYER* pl, FIXED tm);
 
 /// Draw stage
-void draw_stage();
+/// < s Stage
+void draw_stage(STAGE* s);
+
+/// Destroy the composed layers
+void destroy_stage();
+
+/// Get the size of the stage state
+/// > Size in bytes
+int stage_state_size();
+
+/// Save the stage state
+/// < s Stage
+/// < out Output
+/// > End of the written bytes
+Uint8* stage_save(STAGE* s, Uint8* out);
 
-/// Get the global speed
-/// > Global speed
-float get_global_speed();
+/// Load the stage state
+/// < s Stage
+/// < in Input
+/// > End of the read bytes
+const Uint8* stage_load(STAGE* s, const Uint8* in);
 
 #endif // __STAGE__
\ No newline at end of file
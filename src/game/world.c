@@ -0,0 +1,371 @@
+/// Game world (source)
+/// (c) 2017 Jani Nykänen
+
+#include "world.h"
+
+#include "obstacle.h"
+#include "coin.h"
+#include "../engine/state.h"
+
+#include "stdlib.h"
+
+/// Maximum amount of hits per query
+#define MAX_HITS 16
+/// Maximum amount of pending events
+#define MAX_EVENTS 16
+
+/// Push obstacle to the game world
+/// < w World
+static void push_obs(WORLD* w)
+{
+    if(w->goalCreated) return;
+
+    int index = rng_int(&w->rng,3);
+
+    w->intervalCount ++;
+    if(w->intervalCount == w->intervalGoal)
+    {
+        w->goalCreated = true;
+        index = 4;
+    }
+
+    push_obstacle(w->obstacles,&w->rng,index);
+}
+
+/// Push coins
+/// < w World
+static void push_coins(WORLD* w)
+{   
+    int m = w->intervalCount < 10 ? 5 : 3;
+
+    if(rng_int(&w->rng,m) == 0 || w->goalCreated) return;
+
+    FIXED posy = fx_int(24 + rng_int(&w->rng,48));
+    FIXED posx = fx_int(128 + rng_int(&w->rng,24) + 16);
+
+    int loop = 0;
+    int loopMax = rng_int(&w->rng,2) + 1;
+    if(rng_int(&w->rng,2) == 0) loopMax ++;
+    if(rng_int(&w->rng,2) == 0) loopMax ++;
+
+    int dist = loopMax == 2 ? 16 : 12;
+
+    for(; loop < loopMax; loop++ )
+    {
+        push_coin(w->coins,&w->rng,posx + fx_int(loop*dist), posy );
+    }
+}
+
+/// Push some nice fish
+/// < w World
+static void push_fish(WORLD* w)
+{
+    if(w->goalCreated)
+        return;
+
+    push_obstacle(w->obstacles,&w->rng,O_FISH);
+}
+
+/// Collide the player with obstacles and coins
+/// < w World
+static void collide_player(WORLD* w)
+{
+    PLAYER* pl = &w->pl;
+    int hits[MAX_HITS];
+    int i = 0;
+    int n;
+
+    // Obstacles hurt if the pixels overlap
+    SDL_Rect src;
+    int x,y;
+    MASK* mask = pl_get_mask();
+    pl_get_frame(pl,&src,&x,&y);
+
+    set_obstacle_boxes(w->obstacles,w->obsBoxes);
+    n = bp_query_box(w->obsBoxes,x,y,src.w,src.h,hits,MAX_HITS);
+    for(; i < n && mask != NULL; i++)
+    {
+        if(ob_hits_mask(w->obstacles,hits[i],mask,src,x,y))
+        {
+            pl_hurt(pl);
+            break;
+        }
+    }
+
+    // Coins are collected
+    set_coin_boxes(w->coins,w->coinBoxes);
+    n = bp_query_box(w->coinBoxes,fx_to_float(pl->pos.x)-2,fx_to_float(pl->pos.y)-12,4.0f,10.0f,hits,MAX_HITS);
+    for(i=0; i < n; i++)
+    {
+        pool_despawn(w->coins,hits[i]);
+        pl->money ++;
+    }
+}
+
+/// Schedule an event after the stage has scrolled a distance.
+/// The event data is how far past the distance the stage has
+/// scrolled when it fires
+/// < w World
+/// < type Event type
+/// < dist Distance
+static void schedule_distance(WORLD* w, int type, FIXED dist)
+{
+    FIXED speed = w->stage.gspeed;
+    // Late phases can push the interval below zero, fire once
+    // per tick then
+    if(dist < 0) dist = 0;
+
+    Sint64 delay = ((Sint64)dist + speed - 1) / speed;
+    if(delay < 1) delay = 1;
+
+    sched_add(w->events,(Uint32)delay,type,(int)(delay*speed - dist));
+}
+
+/// Handle a world event
+/// < user World
+/// < type Event type
+/// < data Scrolled past the event distance
+static void on_event(void* user, int type, int data)
+{
+    WORLD* w = (WORLD*)user;
+
+    switch(type)
+    {
+    // Create a new obstacle
+    case EV_OBSTACLE:
+    {
+        schedule_distance(w,EV_OBSTACLE,w->interval - data);
+        push_obs(w);
+        push_coins(w);
+    }
+    break;
+
+    // Some nice fish
+    case EV_FISH:
+    {
+        int phase = w->phase;
+        int min = (phase < 2) ? 3-phase : 1; 
+        int max = (phase < 2) ? 5 : ((phase < 5) ? 5-phase : 0);
+        schedule_distance(w,EV_FISH,w->interval * ( (max > 0 ? rng_int(&w->rng,max) : 0 ) + min) - data);
+        push_fish(w);
+    }
+    break;
+
+    default:
+        break;
+    }
+}
+
+/// Get the default tuning
+TUNING default_tuning()
+{
+    return (TUNING){fx_int(90),fx_int(100),fx(7.5),20,10};
+}
+
+/// Create a world
+WORLD* create_world(int obsCapacity, int coinCapacity, TUNING t, Uint32 seed)
+{
+    WORLD* w = (WORLD*)calloc(1,sizeof(WORLD));
+    if(w == NULL)
+    {
+        return NULL;
+    }
+
+    w->tuning = t;
+    rng_seed(&w->rng,seed);
+
+    w->obstacles = create_obstacle_pool(obsCapacity);
+    w->coins = create_coin_pool(coinCapacity);
+    w->obsBoxes = create_broadphase(obsCapacity);
+    w->coinBoxes = create_broadphase(coinCapacity);
+    w->events = create_scheduler(MAX_EVENTS);
+    if(w->obstacles == NULL || w->coins == NULL || w->obsBoxes == NULL || w->coinBoxes == NULL
+        || w->events == NULL)
+    {
+        destroy_world(w);
+        return NULL;
+    }
+
+    reset_world(w);
+
+    return w;
+}
+
+/// Reset a world
+void reset_world(WORLD* w)
+{
+    init_stage(&w->stage);
+    w->pl = create_player();
+    pool_clear(w->obstacles);
+    pool_clear(w->coins);
+
+    // Set default values
+    w->phase = 0;
+    w->interval = w->tuning.startInterval;
+    w->tickFrac = 0;
+    sched_clear(w->events);
+    schedule_distance(w,EV_OBSTACLE,w->interval);
+    schedule_distance(w,EV_FISH,fx_mul(w->interval,fx(0.5) + fx_int(rng_int(&w->rng,3) + 1)));
+    w->intervalCount = 0;
+    w->intervalGoal = w->tuning.goalBase;
+    w->goalCreated = false;
+    w->ticks = 0;
+
+    // Older games cannot be rewound to
+    if(w->history != NULL)
+    {
+        world_save(w,w->snap);
+        hist_reset(w->history,w->snap);
+    }
+}
+
+/// Update a world
+void update_world(WORLD* w, PL_INPUT in, FIXED tm)
+{
+    PLAYER* pl = &w->pl;
+
+    // Update components
+    update_stage(&w->stage,pl,tm);
+    FIXED speed = w->stage.gspeed;
+    pl_update(pl,in,speed,tm);
+    update_obstacles(w->obstacles,pl,&w->rng,speed,tm);
+    update_coins(w->coins,speed,tm);
+    collide_player(w);
+
+    // Fire the events of the ticks passed
+    w->tickFrac += tm;
+    int ticks = fx_floor(w->tickFrac);
+    w->tickFrac -= fx_int(ticks);
+    sched_advance(w->events,(Uint32)ticks,on_event,w);
+
+    // Set phase & interval
+    w->phase = pl->money / w->tuning.phaseMoney;
+    w->interval = w->tuning.baseInterval - w->phase*w->tuning.phaseInterval;
+    w->intervalGoal = w->tuning.goalBase + pl->money * (w->phase+1);
+
+    w->ticks ++;
+
+    if(w->history != NULL)
+    {
+        world_save(w,w->snap);
+        hist_push(w->history,w->snap);
+    }
+}
+
+/// Is the game over
+bool world_is_over(WORLD* w)
+{
+    return w->pl.health <= 0 || w->pl.victorous;
+}
+
+/// Get the size of a world state
+int world_state_size(WORLD* w)
+{
+    return (int)(sizeof(RNG) + sizeof(FIXED)*2 + sizeof(int)*3 + sizeof(bool) + sizeof(Uint32))
+        + stage_state_size() + pl_state_size()
+        + pool_state_size(w->obstacles) + pool_state_size(w->coins)
+        + bp_state_size(w->obsBoxes) + bp_state_size(w->coinBoxes)
+        + sched_state_size(w->events);
+}
+
+/// Save the world state
+void world_save(WORLD* w, Uint8* out)
+{
+    out = save_bytes(out,&w->rng,sizeof(RNG));
+    out = stage_save(&w->stage,out);
+    out = pl_save(&w->pl,out);
+    out = save_bytes(out,&w->tickFrac,sizeof(FIXED));
+    out = save_bytes(out,&w->interval,sizeof(FIXED));
+    out = save_bytes(out,&w->phase,sizeof(int));
+    out = save_bytes(out,&w->intervalCount,sizeof(int));
+    out = save_bytes(out,&w->intervalGoal,sizeof(int));
+    out = save_bytes(out,&w->goalCreated,sizeof(bool));
+    out = save_bytes(out,&w->ticks,sizeof(Uint32));
+
+    out = pool_save(w->obstacles,out);
+    out = pool_save(w->coins,out);
+    out = bp_save(w->obsBoxes,out);
+    out = bp_save(w->coinBoxes,out);
+    sched_save(w->events,out);
+}
+
+/// Load a world state
+void world_load(WORLD* w, const Uint8* in)
+{
+    in = load_bytes(in,&w->rng,sizeof(RNG));
+    in = stage_load(&w->stage,in);
+    in = pl_load(&w->pl,in);
+    in = load_bytes(in,&w->tickFrac,sizeof(FIXED));
+    in = load_bytes(in,&w->interval,sizeof(FIXED));
+    in = load_bytes(in,&w->phase,sizeof(int));
+    in = load_bytes(in,&w->intervalCount,sizeof(int));
+    in = load_bytes(in,&w->intervalGoal,sizeof(int));
+    in = load_bytes(in,&w->goalCreated,sizeof(bool));
+    in = load_bytes(in,&w->ticks,sizeof(Uint32));
+
+    in = pool_load(w->obstacles,in);
+    in = pool_load(w->coins,in);
+    in = bp_load(w->obsBoxes,in);
+    in = bp_load(w->coinBoxes,in);
+    sched_load(w->events,in);
+}
+
+/// Record the world state after every update
+int world_record(WORLD* w, int bytes)
+{
+    if(w->history != NULL)
+        return 0;
+
+    int size = world_state_size(w);
+    w->history = create_history(size,bytes);
+    w->snap = (Uint8*)malloc(size);
+    if(w->history == NULL || w->snap == NULL)
+    {
+        destroy_history(w->history);
+        free(w->snap);
+        w->history = NULL;
+        w->snap = NULL;
+        return 1;
+    }
+
+    world_save(w,w->snap);
+    hist_reset(w->history,w->snap);
+
+    return 0;
+}
+
+/// Go back to a recorded state
+int rewind_world(WORLD* w, int ticks)
+{
+    if(w->history == NULL)
+        return 0;
+
+    int n = hist_rewind(w->history,ticks);
+    world_load(w,w->history->state);
+
+    return n;
+}
+
+/// Draw a world
+void draw_world(WORLD* w)
+{
+    draw_stage(&w->stage);
+    draw_coins(w->coins);
+    draw_obstacles(w->obstacles);
+    pl_draw(&w->pl);
+}
+
+/// Destroy a world
+void destroy_world(WORLD* w)
+{
+    if(w == NULL) return;
+
+    destroy_pool(w->obstacles);
+    destroy_pool(w->coins);
+    destroy_broadphase(w->obsBoxes);
+    destroy_broadphase(w->coinBoxes);
+    destroy_scheduler(w->events);
+    destroy_history(w->history);
+    free(w->snap);
+    free(w);
+}
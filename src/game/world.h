@@ -0,0 +1,125 @@
+/// Game world (header)
+/// (c) 2017 Jani Nykänen
+
+#ifndef __WORLD__
+#define __WORLD__
+
+#include "player.h"
+#include "stage.h"
+
+#include "../engine/pool.h"
+#include "../engine/broadphase.h"
+#include "../engine/fixed.h"
+#include "../engine/rng.h"
+#include "../engine/sched.h"
+#include "../engine/history.h"
+
+#include "stdbool.h"
+
+/// World event types
+enum
+{
+    EV_OBSTACLE = 0,
+    EV_FISH = 1,
+};
+
+/// Difficulty tuning
+typedef struct
+{
+    FIXED startInterval; /// Obstacle interval at start
+    FIXED baseInterval; /// Obstacle interval in the first phase
+    FIXED phaseInterval; /// Interval decrease per phase
+    int goalBase; /// Obstacles before the goal without money
+    int phaseMoney; /// Money per phase
+}
+TUNING;
+
+/// Game world. Worlds share nothing but the loaded assets,
+/// so separate worlds can be updated in separate threads
+typedef struct
+{
+    TUNING tuning; /// Tuning
+    RNG rng; /// Random number generator
+    STAGE stage; /// Stage
+    PLAYER pl; /// Player
+    POOL* obstacles; /// Obstacles
+    POOL* coins; /// Coins
+    BROADPHASE* obsBoxes; /// Obstacle hit boxes
+    BROADPHASE* coinBoxes; /// Coin boxes
+    SCHEDULER* events; /// Scheduled events
+    FIXED tickFrac; /// Time not yet advanced in the scheduler
+    HISTORY* history; /// Past states, NULL if not recorded
+    Uint8* snap; /// State buffer for the history
+    FIXED interval; /// Obstacle interval
+    int phase; /// Phase
+    int intervalCount; /// Interval count
+    int intervalGoal; /// Interval goal
+    bool goalCreated; /// Goal created
+    Uint32 ticks; /// Steps since reset
+}
+WORLD;
+
+/// Get the default tuning
+/// > Tuning
+TUNING default_tuning();
+
+/// Create a world. Asset handles are looked up here, so
+/// create worlds before starting threads
+/// < obsCapacity Maximum amount of obstacles
+/// < coinCapacity Maximum amount of coins
+/// < t Tuning
+/// < seed Random seed
+/// > A new world, NULL on error
+WORLD* create_world(int obsCapacity, int coinCapacity, TUNING t, Uint32 seed);
+
+/// Reset a world for a new game. The random sequence continues
+/// < w World
+void reset_world(WORLD* w);
+
+/// Update a world
+/// < w World
+/// < in Player input
+/// < tm Time mul.
+void update_world(WORLD* w, PL_INPUT in, FIXED tm);
+
+/// Is the game over
+/// < w World
+/// > True if the player died or won
+bool world_is_over(WORLD* w);
+
+/// Get the size of a world state
+/// < w World
+/// > Size in bytes
+int world_state_size(WORLD* w);
+
+/// Save the world state. Tuning is not saved
+/// < w World
+/// < out Output, at least world_state_size bytes
+void world_save(WORLD* w, Uint8* out);
+
+/// Load a state saved from a world of the same capacities
+/// < w World
+/// < in Input
+void world_load(WORLD* w, const Uint8* in);
+
+/// Record the world state after every update
+/// < w World
+/// < bytes Memory for the past states in bytes
+/// > 0 on success, 1 on error
+int world_record(WORLD* w, int bytes);
+
+/// Go back to a recorded state
+/// < w World
+/// < ticks Amount of updates to go back
+/// > Amount of updates gone back, limited by the recorded ones
+int rewind_world(WORLD* w, int ticks);
+
+/// Draw a world
+/// < w World
+void draw_world(WORLD* w);
+
+/// Destroy a world
+/// < w World to destroy
+void destroy_world(WORLD* w);
+
+#endif // __WORLD__
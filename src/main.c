@@ -12,6 +12,7 @@
 #include "engine/assets.h"
 
 #include "stdlib.h"
+#include "stdio.h"
 
 /// Configuration
 static CONFIG c;
@@ -26,8 +27,8 @@ static int read_config(const char* path)
         return 1;
     }
 
-    char* param;
-    char* value;
+    char* param = NULL;
+    char* value = NULL;
     int count = 0;
 
     int i = 0;
@@ -54,13 +55,57 @@ static int read_config(const char* path)
             {
                 c.fullscreen = atoi(value);
             }
+            else if(strcmp(param,"window_surface") == 0)
+            {
+                c.windowSurface = atoi(value);
+            }
+            else if(strcmp(param,"tex_depth") == 0)
+            {
+                c.texDepth = atoi(value);
+            }
             else if(strcmp(param,"fps") == 0)
             {
                 c.fps = atoi(value);
             }
             else if(strcmp(param,"asset_path") == 0)
             {
-                strcpy(c.assPath,value);
+                snprintf(c.assPath,256,"%s",value);
+            }
+            else if(strcmp(param,"asset_pack") == 0)
+            {
+                snprintf(c.packPath,256,"%s",value);
+            }
+            else if(strcmp(param,"lazy_assets") == 0)
+            {
+                c.lazyAssets = atoi(value);
+            }
+            else if(strcmp(param,"asset_budget") == 0)
+            {
+                c.assetBudget = atoi(value);
+            }
+            else if(strcmp(param,"hot_reload") == 0)
+            {
+                c.hotReload = atoi(value);
+            }
+            else if(strcmp(param,"atlas") == 0)
+            {
+                c.atlas = atoi(value);
+            }
+            else if(strcmp(param,"max_obstacles") == 0)
+            {
+                c.maxObstacles = atoi(value);
+            }
+            else if(strcmp(param,"max_coins") == 0)
+            {
+                c.maxCoins = atoi(value);
+            }
+            else if(strcmp(param,"fixed_step") == 0)
+            {
+                c.fixedStep = atoi(value);
+            }
+            else if(strcmp(param,"seed") == 0)
+            {
+                c.seed = atoi(value);
             }
             else if(strcmp(param,"canvas_width") == 0)
             {
@@ -97,6 +142,8 @@ int main(int argc, char** argv)
     {
         return 1;
     }
+    set_entity_capacity(c.maxObstacles,c.maxCoins);
+    set_game_seed((Uint32)c.seed);
 
     return app_run(scenes,sceneCount,c);
 }
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include "../engine/controls.h"
 #include "../engine/assets.h"
 #include "../engine/transform.h"
+#include "../engine/transition.h"
+#include "../engine/trig.h"
 
 #include "stdio.h"
 #include "stdlib.h"
@@ -21,14 +23,14 @@
 static FRAME* frameBg;
 /// Frame drawn
 static bool frameDrawn;
-/// Logo bitmap
-static BITMAP* bmpLogo;
-/// Dollars bitmap
-static BITMAP* bmpDollars;
-/// Font bitmap
-static BITMAP* bmpFont;
-/// "Created by" bitmap
-static BITMAP* bmpCreator;
+/// Logo bitmap handle
+static int hLogo;
+/// Dollars bitmap handle
+static int hDollars;
+/// Font bitmap handle
+static int hFont;
+/// "Created by" bitmap handle
+static int hCreator;
 /// Angle
 static float angle;
 /// Title timer
@@ -40,17 +42,17 @@ static int titlePhase;
 /// > 0 on success
 int title_init()
 {
-    frameBg = frame_create(128,96);
+    frameBg = frame_acquire(128,96);
     if(frameBg == NULL)
     {
         return 1;
     }
     frameDrawn = false;
 
-    bmpLogo = get_bitmap("logo");
-    bmpDollars = get_bitmap("dollars");
-    bmpFont = get_bitmap("font2");
-    bmpCreator = get_bitmap("creator");
+    hLogo = get_asset_handle("logo");
+    hDollars = get_asset_handle("dollars");
+    hFont = get_asset_handle("font2");
+    hCreator = get_asset_handle("creator");
 
     angle = 0.0f;
 
@@ -87,6 +89,11 @@ void title_update(float tm)
         titleTimer += 2.0f * tm;
         if(titleTimer >= 60.0f)
         {
+            // Give the background frame back so the
+            // game can reuse it
+            frame_release(frameBg);
+            frameBg = NULL;
+
             app_swap_scene("game");
         }
     }
@@ -108,7 +115,7 @@ void title_draw()
     // "Created by"
     if(titlePhase == 3)
     {
-        draw_bitmap(bmpCreator,0,0,0);
+        draw_bitmap(get_bitmap_handle(hCreator),0,0,0);
         return;
     }
 
@@ -128,16 +135,16 @@ void title_draw()
     if(titlePhase == 2)
     {
         skip = (int)(floor(titleTimer / 10.0f)) +1;
-        draw_skipped_bitmap_region((BITMAP*)frameBg,0,0,128,96, 0,0,skip,skip,0);
+        draw_dissolve((BITMAP*)frameBg,0,0,128,96, 0,0,DISSOLVE_BAYER,titleTimer / 60.0f);
     }
     else if(titlePhase == 0)
     {
         skip = (int)(floor( (60.0f-titleTimer) / 10.0f));
     }
 
-    draw_rotated_bitmap_area(bmpDollars,(int)(64 + sin(angle)*64) % 128,(int)(64 + cos(angle)*64) % 128,skip,angle);
+    draw_rotated_bitmap_area(get_bitmap_handle(hDollars),(int)(64 + fast_sin(angle)*64) % 128,(int)(64 + fast_cos(angle)*64) % 128,skip,angle);
 
-    float scale = 1.0f + sin(angle*5)*0.05f;
+    float scale = 1.0f + fast_sin(angle*5)*0.05f;
     int y = 0;
     if(titlePhase == 0)
     {
@@ -147,11 +154,11 @@ void title_draw()
     {
         y = (int) ( -64 + 64.0f/60.0f * (60.0f-titleTimer));
     }
-    draw_scaled_bitmap_region(bmpLogo,0,0,128,96,-128*(scale-1.0f)/2,y -96*(scale-1.0f)/2,128*scale,96*scale);
+    draw_scaled_bitmap_region(get_bitmap_handle(hLogo),0,0,128,96,-128*(scale-1.0f)/2,y -96*(scale-1.0f)/2,128*scale,96*scale);
 
     if(titlePhase == 1 && (int)floor((angle*100)/30.0f) %2 == 0)
     {
-        draw_text(bmpFont,(Uint8*)"Press Any Key",13,64,72,-1,0,true);
+        draw_text(get_bitmap_handle(hFont),(Uint8*)"Press Any Key",13,64,72,-1,0,true);
     }
 }
 
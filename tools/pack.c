@@ -0,0 +1,146 @@
+/// Asset packer (source)
+/// (c) 2017 Jani Nykänen
+
+#define SDL_MAIN_HANDLED
+
+#include "../src/engine/list.h"
+#include "../src/engine/bitmap.h"
+#include "../src/engine/pack.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+/// Maximum amount of packed bitmaps
+#define MAX_ENTRIES 1024
+
+/// Bitmap paths
+static char paths[MAX_ENTRIES][256];
+/// Entries
+static PACK_ENTRY entries[MAX_ENTRIES];
+/// Entry count
+static unsigned int entryCount;
+
+/// Collect bitmap entries from an asset list
+/// < path List path
+/// > 0 on success, 1 on error
+static int read_list(const char* path)
+{
+    if(load_list(path) != 0)
+    {
+        return 1;
+    }
+
+    int i = 0;
+    for(; i+2 < get_list_word_count(); i++)
+    {
+        if(strcmp(get_list_word(i).data,"bitmap") != 0)
+            continue;
+
+        if(entryCount >= MAX_ENTRIES)
+        {
+            printf("Too many bitmaps in %s!\n",path);
+            return 1;
+        }
+
+        memset(&entries[entryCount],0,sizeof(PACK_ENTRY));
+        strncpy(entries[entryCount].name,get_list_word(i+1).data,63);
+        snprintf(paths[entryCount],256,"%s",get_list_word(i+2).data);
+        entryCount ++;
+
+        i += 2;
+    }
+
+    return 0;
+}
+
+/// Write padding up to pack alignment
+/// < f File
+/// < pos Current position
+/// > New position
+static Uint32 write_padding(FILE* f, Uint32 pos)
+{
+    while(pos % PACK_ALIGN != 0)
+    {
+        fputc(0,f);
+        pos ++;
+    }
+    return pos;
+}
+
+/// Write the pack
+/// < path Output path
+/// > 0 on success, 1 on error
+static int write_pack(const char* path)
+{
+    BITMAP* bitmaps[MAX_ENTRIES];
+
+    // Load & quantise bitmaps, and compute offsets
+    Uint32 pos = sizeof(PACK_HEADER) + sizeof(PACK_ENTRY) * entryCount;
+    pos = (pos + PACK_ALIGN-1) / PACK_ALIGN * PACK_ALIGN;
+    int i = 0;
+    for(; i < entryCount; i++)
+    {
+        bitmaps[i] = load_bitmap(paths[i]);
+        if(bitmaps[i] == NULL)
+        {
+            return 1;
+        }
+
+        entries[i].w = bitmaps[i]->w;
+        entries[i].h = bitmaps[i]->h;
+        entries[i].offset = pos;
+        entries[i].size = bitmaps[i]->w * bitmaps[i]->h;
+
+        pos += entries[i].size;
+        pos = (pos + PACK_ALIGN-1) / PACK_ALIGN * PACK_ALIGN;
+    }
+
+    FILE* f = fopen(path,"wb");
+    if(f == NULL)
+    {
+        printf("Failed to create a file in %s!\n",path);
+        return 1;
+    }
+
+    // Header & index
+    PACK_HEADER head = {PACK_MAGIC,PACK_VERSION,entryCount,0};
+    fwrite(&head,sizeof(PACK_HEADER),1,f);
+    fwrite(entries,sizeof(PACK_ENTRY),entryCount,f);
+    pos = write_padding(f,sizeof(PACK_HEADER) + sizeof(PACK_ENTRY) * entryCount);
+
+    // Bitmap data
+    for(i=0; i < entryCount; i++)
+    {
+        fwrite(bitmaps[i]->data,1,entries[i].size,f);
+        pos = write_padding(f,pos + entries[i].size);
+
+        destroy_bitmap(bitmaps[i]);
+    }
+
+    fclose(f);
+
+    printf("Packed %d bitmaps to %s (%d bytes)\n",entryCount,path,pos);
+
+    return 0;
+}
+
+/// Main function
+/// < argc Argument count
+/// < argv Argument values
+/// > Error code, 0 on success, 1 on error
+int main(int argc, char** argv)
+{
+    if(argc < 3)
+    {
+        printf("Usage: pack <asset list> <output pack>\n");
+        return 1;
+    }
+
+    if(read_list(argv[1]) != 0 || write_pack(argv[2]) != 0)
+    {
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,314 @@
+/// Headless game simulator (source)
+/// (c) 2017 Jani Nykänen
+
+#define SDL_MAIN_HANDLED
+
+#include "../src/game/world.h"
+#include "../src/engine/assets.h"
+#include "../src/engine/trig.h"
+
+#include "SDL2/SDL.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+/// Maximum amount of threads
+#define MAX_THREADS 64
+/// Maximum amount of rewinds per game
+#define MAX_REWINDS 3
+/// Memory for the past states of a world
+#define HISTORY_BYTES (256*1024)
+
+/// Bot that plays a world
+typedef struct
+{
+    RNG rng; /// Random number generator
+    int reach; /// How far ahead obstacles are noticed
+    int hold; /// Steps left to hold the jump
+}
+BOT;
+
+/// Results of one world
+typedef struct
+{
+    int games; /// Games played
+    int wins; /// Games won
+    int deaths; /// Games lost
+    int timeouts; /// Games cut at the tick limit
+    Uint64 ticks; /// Ticks simulated
+    Uint32 minTicks; /// Shortest game
+    Uint32 maxTicks; /// Longest game
+    Uint64 money; /// Money collected
+    int maxMoney; /// Most money in a game
+    int rewinds; /// Rewinds after a death
+}
+RESULT;
+
+/// Simulation options
+static int worldCount = 64;
+static int threadCount = 4;
+static int gamesPerWorld = 10;
+static int tickLimit = 60*60*10;
+static int botReach = 24;
+static int rewindTicks = 0;
+static Uint32 seed = 1;
+static TUNING tuning;
+
+/// Worlds
+static WORLD** worlds;
+/// Results
+static RESULT* results;
+
+/// Get the input of a bot
+/// < b Bot
+/// < w World
+/// > Player input
+static PL_INPUT bot_input(BOT* b, WORLD* w)
+{
+    PL_INPUT in = (PL_INPUT){false,false,false};
+    PLAYER* pl = &w->pl;
+
+    // Hold the jump for a while, then let go
+    if(b->hold > 0)
+    {
+        b->hold --;
+        in.down = b->hold > 0;
+        in.released = b->hold == 0;
+        return in;
+    }
+
+    if(!pl->canJump) return in;
+
+    // Jump when something solid is close enough
+    int hits[1];
+    float x = fx_to_float(pl->pos.x) + 6;
+    float reach = (float)(b->reach + rng_int(&b->rng,8));
+    if(bp_query_box(w->obsBoxes,x,0.0f,reach,96.0f,hits,1) > 0)
+    {
+        in.pressed = true;
+        in.down = true;
+        b->hold = 6 + rng_int(&b->rng,14);
+    }
+
+    return in;
+}
+
+/// Simulate worlds
+/// < data First world index
+/// > 0
+static int sim_worker(void* data)
+{
+    int i = (int)(intptr_t)data;
+    for(; i < worldCount; i += threadCount)
+    {
+        WORLD* w = worlds[i];
+        RESULT* r = &results[i];
+        BOT b;
+        rng_seed(&b.rng,seed ^ (0x85EBCA6B * (Uint32)(i+1)));
+        b.reach = botReach;
+        b.hold = 0;
+
+        r->minTicks = 0xFFFFFFFF;
+        for(; r->games < gamesPerWorld; r->games ++)
+        {
+            int rewinds = 0;
+            for(;;)
+            {
+                while(!world_is_over(w) && w->ticks < tickLimit)
+                {
+                    update_world(w,bot_input(&b,w),FIXED_ONE);
+                }
+
+                // Try again from a moment before the death
+                if(w->pl.health > 0 || rewinds >= MAX_REWINDS
+                    || rewind_world(w,rewindTicks) == 0)
+                    break;
+
+                rewinds ++;
+                r->rewinds ++;
+                b.hold = 0;
+            }
+
+            if(w->pl.victorous) r->wins ++;
+            else if(w->pl.health <= 0) r->deaths ++;
+            else r->timeouts ++;
+
+            r->ticks += w->ticks;
+            if(w->ticks < r->minTicks) r->minTicks = w->ticks;
+            if(w->ticks > r->maxTicks) r->maxTicks = w->ticks;
+            r->money += w->pl.money;
+            if(w->pl.money > r->maxMoney) r->maxMoney = w->pl.money;
+
+            reset_world(w);
+            b.hold = 0;
+        }
+    }
+
+    return 0;
+}
+
+/// Print the aggregate statistics
+/// < ms Wall clock time in milliseconds
+static void print_results(Uint32 ms)
+{
+    RESULT t;
+    memset(&t,0,sizeof(RESULT));
+    t.minTicks = 0xFFFFFFFF;
+
+    int i = 0;
+    for(; i < worldCount; i++)
+    {
+        t.games += results[i].games;
+        t.wins += results[i].wins;
+        t.deaths += results[i].deaths;
+        t.timeouts += results[i].timeouts;
+        t.ticks += results[i].ticks;
+        t.money += results[i].money;
+        if(results[i].minTicks < t.minTicks) t.minTicks = results[i].minTicks;
+        if(results[i].maxTicks > t.maxTicks) t.maxTicks = results[i].maxTicks;
+        if(results[i].maxMoney > t.maxMoney) t.maxMoney = results[i].maxMoney;
+        t.rewinds += results[i].rewinds;
+    }
+    if(t.games == 0) return;
+
+    printf("Simulated %d games in %d worlds with %d threads\n",t.games,worldCount,threadCount);
+    printf("  Ticks: %llu in %.2f s (%.0f ticks/s)\n",(unsigned long long)t.ticks,ms / 1000.0,
+        ms > 0 ? t.ticks * 1000.0 / ms : 0.0);
+    printf("  Wins: %d (%.1f%%), deaths: %d, timeouts: %d\n",t.wins,100.0 * t.wins / t.games,
+        t.deaths,t.timeouts);
+    printf("  Game length: mean %.1f s, min %.1f s, max %.1f s\n",
+        t.ticks / 60.0 / t.games,t.minTicks / 60.0,t.maxTicks / 60.0);
+    printf("  Money: mean %.2f, max %d\n",(double)t.money / t.games,t.maxMoney);
+    if(rewindTicks > 0)
+        printf("  Rewinds: %d\n",t.rewinds);
+}
+
+/// Print usage
+static void print_usage()
+{
+    printf("Usage: sim [options]\n"
+        "  -w <n>  World count (64)\n"
+        "  -t <n>  Thread count (4)\n"
+        "  -g <n>  Games per world (10)\n"
+        "  -l <n>  Tick limit per game (36000)\n"
+        "  -s <n>  Random seed (1)\n"
+        "  -r <n>  Bot reach in pixels (24)\n"
+        "  -k <n>  Ticks to rewind on a death, at most 3 times a game (0)\n"
+        "  -i <f>  Start interval (90)\n"
+        "  -b <f>  Base interval (100)\n"
+        "  -p <f>  Interval decrease per phase (7.5)\n"
+        "  -G <n>  Goal base (20)\n"
+        "  -m <n>  Money per phase (10)\n"
+        "  -a <path>  Asset list (assets/assets.list)\n");
+}
+
+/// Main function
+/// < argc Argument count
+/// < argv Argument values
+/// > Error code, 0 on success, 1 on error
+int main(int argc, char** argv)
+{
+    const char* assetPath = "assets/assets.list";
+    tuning = default_tuning();
+
+    int i = 1;
+    for(; i < argc; i += 2)
+    {
+        if(argv[i][0] != '-' || argv[i][1] == '\0' || i+1 >= argc)
+        {
+            print_usage();
+            return 1;
+        }
+
+        const char* v = argv[i+1];
+        switch(argv[i][1])
+        {
+        case 'w': worldCount = atoi(v); break;
+        case 't': threadCount = atoi(v); break;
+        case 'g': gamesPerWorld = atoi(v); break;
+        case 'l': tickLimit = atoi(v); break;
+        case 's': seed = (Uint32)strtoul(v,NULL,10); break;
+        case 'r': botReach = atoi(v); break;
+        case 'k': rewindTicks = atoi(v); break;
+        case 'i': tuning.startInterval = fx_from_float((float)atof(v)); break;
+        case 'b': tuning.baseInterval = fx_from_float((float)atof(v)); break;
+        case 'p': tuning.phaseInterval = fx_from_float((float)atof(v)); break;
+        case 'G': tuning.goalBase = atoi(v); break;
+        case 'm': tuning.phaseMoney = atoi(v); break;
+        case 'a': assetPath = v; break;
+
+        default:
+            print_usage();
+            return 1;
+        }
+    }
+
+    if(worldCount <= 0 || threadCount <= 0 || threadCount > MAX_THREADS
+        || gamesPerWorld <= 0 || tickLimit <= 0 || tuning.phaseMoney <= 0
+        || rewindTicks < 0)
+    {
+        print_usage();
+        return 1;
+    }
+    if(threadCount > worldCount)
+        threadCount = worldCount;
+
+    // The workers share the sine table
+    init_trig();
+
+    // Collision masks come from the bitmaps
+    if(load_assets(assetPath) != 0)
+    {
+        return 1;
+    }
+
+    // Worlds are created here, since it looks up asset handles
+    worlds = (WORLD**)calloc(worldCount,sizeof(WORLD*));
+    results = (RESULT*)calloc(worldCount,sizeof(RESULT));
+    if(worlds == NULL || results == NULL)
+    {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+    for(i=0; i < worldCount; i++)
+    {
+        worlds[i] = create_world(8,12,tuning,seed + 0x9E3779B9 * (Uint32)i);
+        if(worlds[i] == NULL)
+        {
+            printf("Failed to create a world!\n");
+            return 1;
+        }
+        if(rewindTicks > 0 && world_record(worlds[i],HISTORY_BYTES) != 0)
+        {
+            printf("Failed to allocate memory for the world history!\n");
+            return 1;
+        }
+    }
+
+    // Worlds share nothing, so every thread takes its own
+    SDL_Thread* threads[MAX_THREADS];
+    Uint32 start = SDL_GetTicks();
+    for(i=0; i < threadCount; i++)
+    {
+        threads[i] = SDL_CreateThread(sim_worker,"sim_worker",(void*)(intptr_t)i);
+        if(threads[i] == NULL)
+            sim_worker((void*)(intptr_t)i);
+    }
+    for(i=0; i < threadCount; i++)
+    {
+        SDL_WaitThread(threads[i],NULL);
+    }
+
+    print_results(SDL_GetTicks() - start);
+
+    for(i=0; i < worldCount; i++)
+    {
+        destroy_world(worlds[i]);
+    }
+    free(worlds);
+    free(results);
+    destroy_assets();
+
+    return 0;
+}